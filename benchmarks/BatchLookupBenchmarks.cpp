@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include <boost/any.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/utility/string_view.hpp>
+#include <boost/variant/get.hpp>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "../src/TdbVectorMapBatch.h"
+#include "../src/TdbVectorStorage.h"
+#include "Benchmark.h"
+
+
+namespace sharemind {
+namespace benchmarks {
+
+namespace {
+
+/*
+  The batches of vector maps used to be a std::map<std::string, boost::any>
+  of boost::ptr_vectors. Every syscall copied the key from its constant
+  reference into a std::string, searched the map and any_cast the vector.
+*/
+using OldBatch = std::map<std::string, boost::any>;
+using OldVector = boost::ptr_vector<SharemindTdbIndex>;
+
+std::uint64_t oldLookups(OldBatch & batch,
+                         std::vector<std::string> const & keys)
+{
+    std::uint64_t found = 0u;
+    for (auto const & k : keys) {
+        std::string const key(k.c_str(), k.size());
+        auto const it = batch.find(key);
+        if (it != batch.end())
+            found += boost::any_cast<OldVector>(&it->second)->size();
+    }
+    return found;
+}
+
+std::uint64_t newLookups(TdbVectorMapBatch & batch,
+                         std::vector<std::string> const & keys)
+{
+    using Vector = TdbVectorStorage<SharemindTdbIndex>;
+    std::uint64_t found = 0u;
+    for (auto const & k : keys) {
+        boost::string_view const key(k.c_str(), k.size());
+        if (auto * const vec = batch.find(key))
+            found += boost::get<Vector>(vec)->size();
+    }
+    return found;
+}
+
+} // anonymous namespace
+
+void runBatchLookupBenchmarks(Benchmark & b) {
+    for (std::uint64_t const n : {10u, 100u, 1000u}) {
+        std::vector<std::string> keys;
+        keys.reserve(n);
+        for (std::uint64_t i = 0u; i < n; ++i)
+            keys.push_back("column_" + std::to_string(i));
+
+        OldBatch oldBatch;
+        TdbVectorMapBatch newBatch;
+        for (auto const & key : keys) {
+            oldBatch.insert(OldBatch::value_type(key, OldVector()));
+            newBatch.emplace<SharemindTdbIndex>(key);
+        }
+
+        b.runTimed("batch/lookup/old", n, [&oldBatch, &keys]() {
+            doNotOptimize(oldLookups(oldBatch, keys));
+        });
+        b.runTimed("batch/lookup/new", n, [&newBatch, &keys]() {
+            doNotOptimize(newLookups(newBatch, keys));
+        });
+    }
+}
+
+} /* namespace benchmarks { */
+} /* namespace sharemind { */
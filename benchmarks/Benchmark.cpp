@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Benchmark.h"
+
+
+namespace sharemind {
+namespace benchmarks {
+
+constexpr std::chrono::milliseconds Benchmark::minTime;
+constexpr std::uint64_t Benchmark::maxRuns;
+
+void Benchmark::report(std::string const & name,
+                       std::uint64_t const items,
+                       std::uint64_t const runs,
+                       Stopwatch::Clock::duration const elapsed,
+                       std::uint64_t const bytes)
+{
+    using Ns = std::chrono::duration<double, std::nano>;
+    auto const totalNs = std::chrono::duration_cast<Ns>(elapsed).count();
+    auto const total = static_cast<double>(items ? items : 1u)
+                       * static_cast<double>(runs);
+    auto const ns = totalNs / total;
+    std::cout << std::left << std::setw(48) << name
+              << std::right << std::setw(10) << items << " items "
+              << std::fixed << std::setprecision(2) << std::setw(14) << ns
+              << " ns/item " << std::setw(16) << std::setprecision(0)
+              << (ns > 0.0 ? 1e9 / ns : 0.0) << " items/s";
+    if (bytes && totalNs > 0.0)
+        std::cout << std::setw(12) << std::setprecision(1)
+                  << (static_cast<double>(bytes) * static_cast<double>(runs)
+                      * 1e9 / totalNs / (1024.0 * 1024.0))
+                  << " MiB/s";
+    std::cout << std::endl;
+}
+
+int benchmarkMain(int argc, char * argv[], void (* f)(Benchmark & b)) {
+    std::uint64_t maxSize = 10000000u;
+    std::string filter;
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--max-size") && i + 1 < argc) {
+            maxSize = std::strtoull(argv[++i], nullptr, 10);
+        } else if (argv[i][0] != '-' && filter.empty()) {
+            filter = argv[i];
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--max-size N] [benchmark name filter]"
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<std::uint64_t> sizes;
+    for (std::uint64_t size = 1u; size <= maxSize; size *= 10u)
+        sizes.push_back(size);
+
+    try {
+        Benchmark b(std::move(sizes), std::move(filter));
+        f(b);
+    } catch (std::exception const & e) {
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+} /* namespace benchmarks { */
+} /* namespace sharemind { */
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+
+#ifndef SHAREMIND_MOD_TABLEDB_BENCHMARKS_BENCHMARK_H
+#define SHAREMIND_MOD_TABLEDB_BENCHMARKS_BENCHMARK_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace sharemind {
+namespace benchmarks {
+
+/** \brief Accumulates the time spent in the measured parts of a run. */
+class Stopwatch {
+
+public: /* Types: */
+
+    using Clock = std::chrono::steady_clock;
+
+public: /* Methods: */
+
+    void start() noexcept { m_start = Clock::now(); }
+    void stop() noexcept { m_elapsed += Clock::now() - m_start; }
+
+    Clock::duration elapsed() const noexcept { return m_elapsed; }
+
+private: /* Fields: */
+
+    Clock::time_point m_start;
+    Clock::duration m_elapsed = Clock::duration::zero();
+
+}; /* class Stopwatch { */
+
+/**
+  \brief Runs benchmarks and prints the time per item of every benchmark.
+
+  A benchmark is a function taking a Stopwatch and processing the given number
+  of items, which only times the parts it measures. It is repeated until it
+  has been timed for long enough to give a stable figure.
+*/
+class Benchmark {
+
+public: /* Methods: */
+
+    Benchmark(std::vector<std::uint64_t> sizes, std::string filter)
+        : m_sizes(std::move(sizes))
+        , m_filter(std::move(filter))
+    {}
+
+    /** \returns the item counts benchmarks are run at, ascending. */
+    std::vector<std::uint64_t> const & sizes() const noexcept
+    { return m_sizes; }
+
+    /** \returns whether benchmarks of the given name are to be run. */
+    bool enabled(std::string const & name) const noexcept
+    { return m_filter.empty() || name.find(m_filter) != std::string::npos; }
+
+    template <typename F>
+    void run(std::string const & name, std::uint64_t const items, F && f)
+    { run(name, items, 0u, std::forward<F>(f)); }
+
+    /**
+      \brief Runs the given benchmark, which moves the given number of bytes
+             per run, and also prints the throughput in bytes.
+    */
+    template <typename F>
+    void run(std::string const & name,
+             std::uint64_t const items,
+             std::uint64_t const bytes,
+             F && f)
+    {
+        if (!enabled(name))
+            return;
+        Stopwatch sw;
+        std::uint64_t runs = 0u;
+        do {
+            f(sw);
+            ++runs;
+        } while (sw.elapsed() < minTime && runs < maxRuns);
+        report(name, items, runs, sw.elapsed(), bytes);
+    }
+
+    /** \brief Runs the given benchmark timed as a whole. */
+    template <typename F>
+    void runTimed(std::string const & name, std::uint64_t const items, F && f) {
+        run(name,
+            items,
+            [&f](Stopwatch & sw) {
+                sw.start();
+                f();
+                sw.stop();
+            });
+    }
+
+    /** \brief Prints a result measured elsewhere, e.g. by another process. */
+    static void report(std::string const & name,
+                       std::uint64_t items,
+                       std::uint64_t runs,
+                       Stopwatch::Clock::duration elapsed,
+                       std::uint64_t bytes = 0u);
+
+private: /* Fields: */
+
+    static constexpr std::chrono::milliseconds minTime{200};
+    static constexpr std::uint64_t maxRuns = 1000000u;
+
+    std::vector<std::uint64_t> const m_sizes;
+    std::string const m_filter;
+
+}; /* class Benchmark { */
+
+/** \brief Keeps the compiler from optimizing away the computation of v. */
+template <typename T>
+inline void doNotOptimize(T const & v) noexcept
+{ asm volatile("" : : "g"(&v) : "memory"); }
+
+/**
+  \brief Parses the command line of a benchmark executable and calls f with
+         the benchmark to run.
+  \returns the exit status of the executable.
+*/
+int benchmarkMain(int argc, char * argv[], void (* f)(Benchmark & b));
+
+void runVectorMapBenchmarks(Benchmark & b);
+void runBatchLookupBenchmarks(Benchmark & b);
+void runDispatchBenchmarks(Benchmark & b);
+
+} /* namespace benchmarks { */
+} /* namespace sharemind { */
+
+#endif /* SHAREMIND_MOD_TABLEDB_BENCHMARKS_BENCHMARK_H */
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include <boost/utility/string_view.hpp>
+#include <cstdint>
+#include <memory>
+#include <sharemind/libmodapi/libmodapi.h>
+#include <sharemind/SimpleUnorderedStringMap.h>
+#include <string>
+#include <vector>
+#include "../src/DataSource.h"
+#include "../src/DataSourceManager.h"
+#include "Benchmark.h"
+
+
+namespace sharemind {
+namespace benchmarks {
+
+namespace {
+
+char const * const signatures[] = {
+    "tdb_open",
+    "tdb_close",
+    "tdb_table_names",
+    "tdb_tbl_create",
+    "tdb_tbl_create2",
+    "tdb_tbl_delete",
+    "tdb_tbl_exists",
+    "tdb_tbl_col_count",
+    "tdb_tbl_col_names",
+    "tdb_tbl_col_types",
+    "tdb_tbl_row_count",
+    "tdb_insert_row",
+    "tdb_insert_row2",
+    "tdb_read_col",
+    "tdb_get_attributes",
+    "tdb_set_attributes"
+};
+constexpr std::size_t numSignatures =
+        sizeof(signatures) / sizeof(signatures[0u]);
+
+SharemindModuleApi0x1Error dummySyscall(SharemindCodeBlock *,
+                                        std::size_t,
+                                        SharemindModuleApi0x1Reference const *,
+                                        SharemindModuleApi0x1CReference const *,
+                                        SharemindCodeBlock *,
+                                        SharemindModuleApi0x1SyscallContext *)
+{ return SHAREMIND_MODULE_API_0x1_OK; }
+
+/*
+  Forwarding a syscall used to copy the data source name from its constant
+  reference into a std::string, look the data source up by it, and then look
+  up the database module of the data source and the syscall signature, passed
+  as a std::string built from the syscall name, in two more string keyed maps.
+*/
+struct OldDispatch {
+
+    using SyscallMap =
+            SimpleUnorderedStringMap<std::unique_ptr<SharemindSyscallWrapper> >;
+
+    SharemindSyscallWrapper lookup(char const * const dsName,
+                                   std::size_t const dsNameSize,
+                                   std::string const & signature) const
+    {
+        std::string const name(dsName, dsNameSize);
+        auto const dsit(dataSources.find(name));
+        if (dsit == dataSources.end())
+            return {nullptr, nullptr};
+        auto const msit(moduleSyscalls.find(dsit->second->module()));
+        if (msit == moduleSyscalls.end())
+            return {nullptr, nullptr};
+        auto const sit(msit->second.find(signature));
+        if (sit == msit->second.end())
+            return {nullptr, nullptr};
+        return *sit->second;
+    }
+
+    SimpleUnorderedStringMap<std::unique_ptr<DataSource> > dataSources;
+    SimpleUnorderedStringMap<SyscallMap> moduleSyscalls;
+
+};
+
+} // anonymous namespace
+
+void runDispatchBenchmarks(Benchmark & b) {
+    // A wrapper per signature, told apart by their internal pointers:
+    std::vector<SharemindSyscallWrapper> syscallTable;
+    for (std::size_t i = 0u; i < numSignatures; ++i)
+        syscallTable.push_back(
+                    SharemindSyscallWrapper{
+                        &dummySyscall,
+                        reinterpret_cast<void *>(i + 1u)});
+
+    for (std::uint64_t const n : {1u, 10u, 100u}) {
+        std::vector<std::string> names;
+        OldDispatch oldDispatch;
+        DataSourceManager newDispatch;
+        for (std::uint64_t i = 0u; i < n; ++i) {
+            names.push_back("DS" + std::to_string(i));
+            auto const module("module" + std::to_string(i));
+
+            oldDispatch.dataSources.emplace(
+                        names.back(),
+                        std::make_unique<DataSource>(names.back(),
+                                                     module,
+                                                     std::string()));
+            auto & syscalls = oldDispatch.moduleSyscalls[module];
+            for (std::size_t j = 0u; j < numSignatures; ++j)
+                syscalls.emplace(signatures[j],
+                                 std::make_unique<SharemindSyscallWrapper>(
+                                     syscallTable[j]));
+
+            newDispatch.addDataSource(names.back(), module, std::string());
+            newDispatch.getDataSource(names.back())->setSyscallTable(
+                        &syscallTable);
+        }
+
+        auto const calls = n * numSignatures;
+        b.runTimed("dispatch/" + std::to_string(n) + "_ds/old",
+                   calls,
+                   [&oldDispatch, &names]() {
+            for (auto const & name : names)
+                for (char const * const signature : signatures)
+                    doNotOptimize(oldDispatch.lookup(name.c_str(),
+                                                     name.size(),
+                                                     signature));
+        });
+        b.runTimed("dispatch/" + std::to_string(n) + "_ds/new",
+                   calls,
+                   [&newDispatch, &names]() {
+            for (auto const & name : names) {
+                boost::string_view const dsName(name.c_str(), name.size());
+                for (std::size_t i = 0u; i < numSignatures; ++i) {
+                    auto const * const src = newDispatch.getDataSource(dsName);
+                    doNotOptimize(src->syscall(i));
+                }
+            }
+        });
+    }
+}
+
+} /* namespace benchmarks { */
+} /* namespace sharemind { */
@@ -0,0 +1,503 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+/*
+  Measures the syscalls of the TableDB module end to end, as called by a
+  process, with the mock database module as the database. Every workload is
+  also run on the mock database module directly, without the TableDB module in
+  between, so that the difference of the two is the cost of forwarding the
+  syscalls and of the vector maps passed to them.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <initializer_list>
+#include <LogHard/Backend.h>
+#include <LogHard/Logger.h>
+#include <LogHard/StdAppender.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "../mock/StandInProcess.h"
+#include "../src/ModuleLoader.h"
+#include "../src/TdbVectorMap.h"
+#include "../src/TdbVectorMapUtil.h"
+#include "Benchmark.h"
+
+
+namespace sharemind {
+namespace benchmarks {
+
+namespace {
+
+constexpr std::uint64_t numColumns = 4u;
+constexpr std::uint64_t maxRowsPerInsert = 10000u;
+constexpr std::uint64_t maxTableRows = 1000000u;
+
+char const dsName[] = "DS1";
+char const tblName[] = "bench";
+
+/*
+  The syscalls used, in the order of their signatures given to the module
+  loaders. The mock database module is only loaded with the first ones.
+*/
+enum Syscall : std::size_t {
+    TblCreate2,
+    TblDelete,
+    TblRowCount,
+    InsertRow,
+    ReadCol,
+    NumDbSyscalls,
+
+    VmapNew = NumDbSyscalls,
+    VmapDelete,
+    VmapAddBatch,
+    VmapPushBackString,
+    VmapPushBackType,
+    VmapPushBackValueVector,
+    VmapReadValueVector
+};
+
+std::vector<std::string> const signatures{
+    "tdb_tbl_create2",
+    "tdb_tbl_delete",
+    "tdb_tbl_row_count",
+    "tdb_insert_row",
+    "tdb_read_col",
+    "tdb_vmap_new",
+    "tdb_vmap_delete",
+    "tdb_vmap_add_batch",
+    "tdb_vmap_push_back_string",
+    "tdb_vmap_push_back_type",
+    "tdb_vmap_push_back_value_vector",
+    "tdb_vmap_read_value_vector"
+};
+
+using CRef = SharemindModuleApi0x1CReference;
+using Ref = SharemindModuleApi0x1Reference;
+
+CRef cref(char const * str) noexcept
+{ return CRef{str, std::char_traits<char>::length(str) + 1u}; }
+
+template <typename T>
+CRef cref(std::vector<T> const & v) noexcept
+{ return CRef{v.data(), v.size() * sizeof(T)}; }
+
+/** \brief Calls the syscalls of a loaded module in the stand-in process. */
+class Syscalls {
+
+public: /* Methods: */
+
+    Syscalls(ModuleLoader const & loader,
+             std::string const & module,
+             mock::StandInProcess & process)
+        : m_table(loader.syscallTable(module))
+        , m_process(process)
+    {
+        if (!m_table)
+            throw std::runtime_error("Module \"" + module + "\" not loaded!");
+    }
+
+    /**
+      \returns the return value of the syscall.
+      \throws std::runtime_error if the syscall fails.
+    */
+    std::uint64_t operator()(Syscall const syscall,
+                             std::initializer_list<std::uint64_t> args,
+                             std::initializer_list<CRef> crefs,
+                             Ref const * const refs = nullptr) const
+    {
+        assert(syscall < m_table->size());
+        assert(args.size() <= 4u);
+        assert(crefs.size() <= 4u);
+        SharemindCodeBlock a[4u];
+        std::size_t n = 0u;
+        for (auto const arg : args)
+            a[n++].uint64[0u] = arg;
+        CRef c[5u];
+        std::copy(crefs.begin(), crefs.end(), c);
+        c[crefs.size()] = CRef{nullptr, 0u};
+        SharemindCodeBlock returnValue;
+        returnValue.uint64[0u] = 0u;
+
+        auto const & wrapper = (*m_table)[syscall];
+        auto context(m_process.context(wrapper.internal));
+        if (wrapper.callable(a, n, refs, c, &returnValue, &context)
+                != SHAREMIND_MODULE_API_0x1_OK)
+            throw std::runtime_error("Syscall " + signatures[syscall]
+                                     + " failed!");
+        return returnValue.uint64[0u];
+    }
+
+private: /* Fields: */
+
+    ModuleLoader::SyscallTable const * const m_table;
+    mock::StandInProcess & m_process;
+
+}; /* class Syscalls { */
+
+/** \brief A temporary configuration of the TableDB module. */
+class Configuration {
+
+public: /* Methods: */
+
+    Configuration() {
+        char dir[] = "/tmp/mod_tabledb_benchmarks.XXXXXX";
+        if (!::mkdtemp(dir))
+            throw std::runtime_error("Failed to create a temporary directory!");
+        m_directory = dir;
+        m_filename = m_directory + "/tabledb.conf";
+        std::ofstream f(m_filename);
+        f << "[DBModule mock]\n"
+             "File = " SHAREMIND_MOD_TABLEDB_BENCHMARKS_MOCK_DB_MODULE "\n"
+             "\n"
+             "[DataSource " << dsName << "]\n"
+             "Name = " << dsName << "\n"
+             "DBModule = tabledb_mock\n"
+             // Not read by the mock database module:
+             "Configuration = " << m_filename << "\n"
+             "TableCache = true\n";
+        if (!f.flush())
+            throw std::runtime_error("Failed to write " + m_filename);
+    }
+
+    ~Configuration() noexcept {
+        std::remove(m_filename.c_str());
+        ::rmdir(m_directory.c_str());
+    }
+
+    std::string const & filename() const noexcept { return m_filename; }
+
+private: /* Fields: */
+
+    std::string m_directory;
+    std::string m_filename;
+
+}; /* class Configuration { */
+
+/**
+  \brief Runs the workloads with either the forwarding TableDB module or the
+         mock database module only.
+*/
+class Workloads {
+
+public: /* Methods: */
+
+    Workloads(Benchmark & b, Syscalls const & syscalls, std::string prefix)
+        : m_b(b)
+        , m_syscalls(syscalls)
+        , m_prefix(std::move(prefix))
+    {}
+
+    virtual ~Workloads() noexcept {}
+
+    void run() {
+        createTable();
+        for (auto const n : m_b.sizes()) {
+            if (n > maxRowsPerInsert)
+                break;
+            benchmarkInsertRow(n);
+        }
+        m_syscalls(TblDelete, {}, {cref(dsName), cref(tblName)});
+
+        for (auto const n : m_b.sizes()) {
+            if (n > maxTableRows)
+                break;
+            createTable();
+            insertRows(n);
+            benchmarkReadCol(n);
+            m_syscalls(TblDelete, {}, {cref(dsName), cref(tblName)});
+        }
+
+        createTable();
+        m_b.runTimed(m_prefix + "/tdb_tbl_row_count", 1u, [this] {
+            doNotOptimize(m_syscalls(TblRowCount,
+                                     {},
+                                     {cref(dsName), cref(tblName)}));
+        });
+        m_syscalls(TblDelete, {}, {cref(dsName), cref(tblName)});
+    }
+
+protected: /* Methods: */
+
+    /** \returns the identifier of a new table creation parameters map. */
+    virtual std::uint64_t newTableParameters() = 0;
+
+    /** \returns the identifier of a new map with n rows to insert. */
+    virtual std::uint64_t newRows(std::uint64_t n) = 0;
+
+    virtual void deleteMap(std::uint64_t id) = 0;
+
+    /** \returns the number of bytes the value vector "values" takes. */
+    virtual std::uint64_t readValues(std::uint64_t id, std::uint64_t n) = 0;
+
+    Benchmark & m_b;
+    Syscalls const & m_syscalls;
+    std::string const m_prefix;
+
+private: /* Methods: */
+
+    void createTable() {
+        auto const params = newTableParameters();
+        m_syscalls(TblCreate2, {params}, {cref(dsName), cref(tblName)});
+        deleteMap(params);
+    }
+
+    void insertRows(std::uint64_t const n) {
+        for (std::uint64_t done = 0u; done < n;) {
+            auto const rows = std::min(n - done, maxRowsPerInsert);
+            auto const params = newRows(rows);
+            m_syscalls(InsertRow, {params}, {cref(dsName), cref(tblName)});
+            deleteMap(params);
+            done += rows;
+        }
+    }
+
+    void benchmarkInsertRow(std::uint64_t const n) {
+        auto const bytes = n * numColumns * sizeof(std::uint64_t);
+        m_b.run(m_prefix + "/vmap/build_rows", n, bytes, [&](Stopwatch & sw) {
+            sw.start();
+            auto const params = newRows(n);
+            sw.stop();
+            deleteMap(params);
+        });
+
+        auto const params = newRows(n);
+        m_b.run(m_prefix + "/tdb_insert_row", n, bytes, [&](Stopwatch & sw) {
+            sw.start();
+            m_syscalls(InsertRow, {params}, {cref(dsName), cref(tblName)});
+            sw.stop();
+        });
+        deleteMap(params);
+    }
+
+    void benchmarkReadCol(std::uint64_t const n) {
+        auto const bytes = n * sizeof(std::uint64_t);
+        m_b.run(m_prefix + "/tdb_read_col", n, bytes, [&](Stopwatch & sw) {
+            sw.start();
+            auto const col = m_syscalls(ReadCol,
+                                        {0u},
+                                        {cref(dsName), cref(tblName)});
+            sw.stop();
+            deleteMap(col);
+        });
+
+        auto const col = m_syscalls(ReadCol, {0u}, {cref(dsName), cref(tblName)});
+        m_b.runTimed(m_prefix + "/vmap/read_values", n, [&] {
+            doNotOptimize(readValues(col, n));
+        });
+        deleteMap(col);
+    }
+
+}; /* class Workloads { */
+
+/** \brief Passes vector maps to the mock database module directly. */
+class DirectWorkloads final: public Workloads {
+
+public: /* Methods: */
+
+    DirectWorkloads(Benchmark & b,
+                    Syscalls const & syscalls,
+                    TdbVectorMapUtil & util,
+                    SharemindDataStore * vectorMaps)
+        : Workloads(b, syscalls, "syscall/direct")
+        , m_util(util)
+        , m_vectorMaps(vectorMaps)
+    {}
+
+private: /* Methods: */
+
+    std::uint64_t newTableParameters() final override {
+        auto & map = *m_util.newVectorMap(m_vectorMaps);
+        for (std::uint64_t i = 0u; i < numColumns; ++i) {
+            auto const name("c" + std::to_string(i));
+            map.push_back<SharemindTdbString>(
+                        "names",
+                        SharemindTdbString_new2(name.c_str(), name.size()));
+            map.push_back<SharemindTdbType>(
+                        "types",
+                        SharemindTdbType_new("public", "uint64", 8u));
+        }
+        return map.getId();
+    }
+
+    std::uint64_t newRows(std::uint64_t const n) final override {
+        SharemindTdbType const type{const_cast<char *>("public"),
+                                    const_cast<char *>("uint64"),
+                                    8u};
+        std::vector<std::uint64_t> const row(numColumns, 42u);
+        auto & map = *m_util.newVectorMap(m_vectorMaps);
+        for (std::uint64_t i = 0u; i < n; ++i) {
+            if (i)
+                map.addBatch();
+            map.getOrCreateVector<SharemindTdbValue>("values").append(
+                        type,
+                        row.data(),
+                        numColumns,
+                        sizeof(std::uint64_t));
+            map.updateUsage("values");
+        }
+        return map.getId();
+    }
+
+    void deleteMap(std::uint64_t const id) final override
+    { m_util.deleteVectorMap(m_vectorMaps, id); }
+
+    std::uint64_t readValues(std::uint64_t const id, std::uint64_t const n)
+            final override
+    {
+        auto const & vec = m_util.getVectorMap(m_vectorMaps, id)
+                                ->getVector<SharemindTdbValue>("values");
+        m_buffer.resize(n * sizeof(std::uint64_t));
+        std::copy(vec.payload(),
+                  vec.payload() + vec.offsets()[n],
+                  m_buffer.begin());
+        return vec.offsets()[n];
+    }
+
+    TdbVectorMapUtil & m_util;
+    SharemindDataStore * const m_vectorMaps;
+    std::vector<unsigned char> m_buffer;
+
+}; /* class DirectWorkloads { */
+
+/** \brief Builds and reads vector maps with the TableDB module syscalls. */
+class ForwardedWorkloads final: public Workloads {
+
+public: /* Methods: */
+
+    ForwardedWorkloads(Benchmark & b, Syscalls const & syscalls)
+        : Workloads(b, syscalls, "syscall/forwarded")
+    {}
+
+private: /* Methods: */
+
+    std::uint64_t newTableParameters() final override {
+        auto const id = m_syscalls(VmapNew, {}, {});
+        for (std::uint64_t i = 0u; i < numColumns; ++i) {
+            auto const name("c" + std::to_string(i));
+            m_syscalls(VmapPushBackString,
+                       {id},
+                       {cref("names"), cref(name.c_str())});
+            m_syscalls(VmapPushBackType,
+                       {id, 8u},
+                       {cref("types"), cref("public"), cref("uint64")});
+        }
+        return id;
+    }
+
+    std::uint64_t newRows(std::uint64_t const n) final override {
+        std::vector<std::uint64_t> const row(numColumns, 42u);
+        auto const id = m_syscalls(VmapNew, {}, {});
+        for (std::uint64_t i = 0u; i < n; ++i) {
+            if (i)
+                m_syscalls(VmapAddBatch, {id}, {});
+            m_syscalls(VmapPushBackValueVector,
+                       {id, 8u, numColumns, sizeof(std::uint64_t)},
+                       {cref("values"),
+                        cref("public"),
+                        cref("uint64"),
+                        cref(row)});
+        }
+        return id;
+    }
+
+    void deleteMap(std::uint64_t const id) final override
+    { m_syscalls(VmapDelete, {id}, {}); }
+
+    std::uint64_t readValues(std::uint64_t const id, std::uint64_t const n)
+            final override
+    {
+        m_buffer.resize(n * sizeof(std::uint64_t));
+        m_offsets.resize(n + 1u);
+        Ref const refs[] = {
+            Ref{m_buffer.data(), m_buffer.size()},
+            Ref{m_offsets.data(), m_offsets.size() * sizeof(std::uint64_t)},
+            Ref{nullptr, 0u}
+        };
+        return m_syscalls(VmapReadValueVector,
+                          {id, 0u, n},
+                          {cref("values")},
+                          refs);
+    }
+
+    std::vector<unsigned char> m_buffer;
+    std::vector<std::uint64_t> m_offsets;
+
+}; /* class ForwardedWorkloads { */
+
+void runThroughputBenchmarks(Benchmark & b) {
+    auto logBackend(std::make_shared<LogHard::Backend>());
+    logBackend->addAppender(std::make_shared<LogHard::StdAppender>());
+    LogHard::Logger const logger(logBackend);
+    mock::StandInProcess process("ModTableDbThroughput");
+
+    /* The mock database module on its own, given the vector map utilities
+       the TableDB module would give it: */
+    {
+        TdbVectorMapUtil util;
+        ModuleLoader loader(
+                std::vector<std::string>(signatures.begin(),
+                                         signatures.begin() + NumDbSyscalls),
+                {},
+                logger);
+        loader.setModuleFacility("TdbVectorMapUtil", util.getWrapper());
+        if (!loader.addModule(SHAREMIND_MOD_TABLEDB_BENCHMARKS_MOCK_DB_MODULE))
+            throw std::runtime_error("Failed to load the mock database!");
+        Syscalls const syscalls(loader, "tabledb_mock", process);
+        DirectWorkloads(b,
+                        syscalls,
+                        util,
+                        process.dataStores().dataStore(
+                            "mod_tabledb/vector_maps")).run();
+        process.end();
+    }
+
+    /* The same through the TableDB module: */
+    {
+        Configuration const configuration;
+        ModuleLoader loader(signatures, {}, logger);
+        loader.setModuleFacility("Logger",
+                                 &const_cast<LogHard::Logger &>(logger));
+        if (!loader.addModule(SHAREMIND_MOD_TABLEDB_BENCHMARKS_MODULE,
+                              configuration.filename()))
+            throw std::runtime_error("Failed to load the TableDB module!");
+        Syscalls const syscalls(loader, "tabledb", process);
+        ForwardedWorkloads(b, syscalls).run();
+        process.end();
+    }
+}
+
+} // anonymous namespace
+
+} /* namespace benchmarks { */
+} /* namespace sharemind { */
+
+int main(int argc, char * argv[]) {
+    return sharemind::benchmarks::benchmarkMain(
+                argc,
+                argv,
+                &sharemind::benchmarks::runThroughputBenchmarks);
+}
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../mock/StandInDataStore.h"
+#include "../src/TdbTypesUtil.h"
+#include "../src/TdbVectorMap.h"
+#include "../src/TdbVectorMapUtil.h"
+#include "Benchmark.h"
+
+
+namespace sharemind {
+namespace benchmarks {
+
+namespace {
+
+/*
+  Values are created with their own copy of the type, hence benchmarks holding
+  all of them at once are capped to keep the memory use within a few GiB:
+*/
+constexpr std::uint64_t maxHeldValues = 1000000u;
+constexpr std::uint64_t maxVectorMaps = 100000u;
+constexpr std::uint64_t maxBatches = 1000u;
+
+SharemindTdbValue * newValue(std::uint64_t const v) {
+    auto * const value =
+            SharemindTdbValue_new2("public", 6u, "uint64", 6u, 8u, &v, 8u);
+    if (!value)
+        throw std::bad_alloc();
+    return value;
+}
+
+void fillIndexes(TdbVectorMap & map, std::uint64_t const n) {
+    auto & vec = map.getOrCreateVector<SharemindTdbIndex>("i");
+    for (std::uint64_t k = 0u; k < n; ++k)
+        vec.push_back(SharemindTdbIndex{k});
+    map.updateUsage("i");
+}
+
+void fillValues(TdbVectorMap & map, std::uint64_t const n) {
+    SharemindTdbType const type{const_cast<char *>("public"),
+                                const_cast<char *>("uint64"),
+                                8u};
+    std::vector<std::uint64_t> data(n);
+    for (std::uint64_t k = 0u; k < n; ++k)
+        data[k] = k;
+    map.getOrCreateVector<SharemindTdbValue>("v").append(type,
+                                                         data.data(),
+                                                         n,
+                                                         8u);
+    map.updateUsage("v");
+}
+
+void benchmarkPushBack(Benchmark & b, std::uint64_t const n) {
+    b.run("vmap/push_back/index", n, [n](Stopwatch & sw) {
+        TdbVectorMap map(1u);
+        sw.start();
+        for (std::uint64_t k = 0u; k < n; ++k)
+            map.push_back<SharemindTdbIndex>("i", SharemindTdbIndex_new(k));
+        sw.stop();
+    });
+    b.run("vmap/push_back/value", n, [n](Stopwatch & sw) {
+        TdbVectorMap map(1u);
+        sw.start();
+        for (std::uint64_t k = 0u; k < n; ++k)
+            map.push_back<SharemindTdbValue>("v", newValue(k));
+        sw.stop();
+    });
+}
+
+void benchmarkAt(Benchmark & b, std::uint64_t const n) {
+    TdbVectorMap map(1u);
+    fillIndexes(map, n);
+    fillValues(map, n);
+    b.runTimed("vmap/at/index", n, [&map, n]() {
+        std::uint64_t sum = 0u;
+        for (std::uint64_t k = 0u; k < n; ++k)
+            sum += map.at<SharemindTdbIndex>("i", k).idx;
+        doNotOptimize(sum);
+    });
+    b.runTimed("vmap/at/value", n, [&map, n]() {
+        std::uint64_t sum = 0u;
+        for (std::uint64_t k = 0u; k < n; ++k)
+            sum += map.at<SharemindTdbValue>("v", k).size;
+        doNotOptimize(sum);
+    });
+    b.runTimed("vmap/getCArray/value", n, [&map]() {
+        SharemindTdbValue ** array;
+        TdbVectorMap::Vector<SharemindTdbValue>::size_type size;
+        map.getCArray<SharemindTdbValue>("v", array, size);
+        doNotOptimize(array);
+    });
+}
+
+void benchmarkSetCArray(Benchmark & b, std::uint64_t const n) {
+    if (n > maxHeldValues)
+        return;
+    b.run("vmap/setCArray/value", n, [n](Stopwatch & sw) {
+        TdbVectorMap map(1u);
+        std::unique_ptr<SharemindTdbValue *[]> array(
+                    new SharemindTdbValue *[n]);
+        for (std::uint64_t k = 0u; k < n; ++k)
+            array[k] = newValue(k);
+        sw.start();
+        map.setCArray<SharemindTdbValue>("v", array.release(), n);
+        sw.stop();
+    });
+}
+
+void benchmarkValueNewDelete(Benchmark & b, std::uint64_t const n) {
+    b.runTimed("types/SharemindTdbValue_new2+delete", n, [n]() {
+        for (std::uint64_t k = 0u; k < n; ++k)
+            SharemindTdbValue_delete(newValue(k));
+    });
+}
+
+void benchmarkSetBatch(Benchmark & b, std::uint64_t const n) {
+    TdbVectorMap map(1u);
+    auto const batches = std::min(n, maxBatches);
+    for (std::uint64_t i = 0u; i < batches; ++i) {
+        if (i)
+            map.addBatch();
+        fillIndexes(map, 1u);
+    }
+    b.runTimed("vmap/setBatch+at", n, [&map, batches, n]() {
+        std::uint64_t sum = 0u;
+        for (std::uint64_t k = 0u; k < n; ++k) {
+            map.setBatch(k % batches);
+            sum += map.at<SharemindTdbIndex>("i", 0u).idx;
+        }
+        doNotOptimize(sum);
+    });
+}
+
+void benchmarkNewDeleteMap(Benchmark & b, std::uint64_t const n) {
+    if (n > maxVectorMaps)
+        return;
+    TdbVectorMapUtil util;
+    mock::StandInDataStore store;
+    std::vector<std::uint64_t> ids;
+    ids.reserve(n);
+    b.runTimed("vmapUtil/new+delete", n, [&util, &store, &ids, n]() {
+        for (std::uint64_t k = 0u; k < n; ++k)
+            ids.push_back(util.newVectorMap(&store)->getId());
+        for (auto const id : ids)
+            util.deleteVectorMap(&store, id);
+        ids.clear();
+    });
+}
+
+} // anonymous namespace
+
+void runVectorMapBenchmarks(Benchmark & b) {
+    for (auto const n : b.sizes()) {
+        benchmarkPushBack(b, n);
+        benchmarkAt(b, n);
+        benchmarkSetCArray(b, n);
+        benchmarkValueNewDelete(b, n);
+        benchmarkSetBatch(b, n);
+        benchmarkNewDeleteMap(b, n);
+    }
+}
+
+} /* namespace benchmarks { */
+} /* namespace sharemind { */
@@ -0,0 +1,677 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+/*
+  An in-memory database module for running the TableDB module without a real
+  database. It implements the required database module syscalls on fixed and
+  variable size values kept in per column buffers, shared by all processes.
+  The syscalls take the same arguments as those of the TableDB module.
+*/
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <sharemind/datastoreapi.h>
+#include <sharemind/module-apis/api_0x1.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../src/TdbTypesUtil.h"
+#include "../src/tdberror.h"
+#include "../src/tdbtypes.h"
+#include "../src/tdbvectormapapi.h"
+
+
+namespace {
+
+struct Column {
+    std::string name;
+    std::string typeDomain;
+    std::string typeName;
+    std::uint64_t typeSize;
+    std::vector<unsigned char> payload;
+    std::vector<std::uint64_t> offsets{0u};
+};
+
+struct Table {
+    std::vector<Column> columns;
+    std::uint64_t rows = 0u;
+};
+
+class MockDb {
+
+public: /* Types: */
+
+    using Tables = std::map<std::pair<std::string, std::string>, Table>;
+
+public: /* Methods: */
+
+    explicit MockDb(SharemindTdbVectorMapUtil & mapUtil) noexcept
+        : m_mapUtil(mapUtil)
+    {}
+
+    std::mutex & mutex() noexcept { return m_mutex; }
+    Tables & tables() noexcept { return m_tables; }
+    SharemindTdbVectorMapUtil & mapUtil() noexcept { return m_mapUtil; }
+
+private: /* Fields: */
+
+    SharemindTdbVectorMapUtil & m_mapUtil;
+    std::mutex m_mutex;
+    Tables m_tables;
+
+}; /* class MockDb { */
+
+MockDb & mockDb(SharemindModuleApi0x1SyscallContext * c) noexcept
+{ return *static_cast<MockDb *>(c->moduleHandle); }
+
+SharemindDataStore * processDataStore(SharemindModuleApi0x1SyscallContext * c,
+                                      char const * const name)
+{
+    auto * const factory =
+            static_cast<SharemindDataStoreFactory *>(
+                c->processFacility(c, "DataStoreFactory"));
+    return factory ? factory->get_datastore(factory, name) : nullptr;
+}
+
+/** \brief Sets the error code of the last call on the data source. */
+void setErrorCode(SharemindModuleApi0x1SyscallContext * c,
+                  char const * const dsName,
+                  SharemindTdbError const code)
+{
+    SharemindDataStore * const errors =
+            processDataStore(c, "mod_tabledb/errors");
+    if (!errors)
+        return;
+    if (auto * const e =
+            static_cast<SharemindTdbError *>(errors->get(errors, dsName)))
+    {
+        *e = code;
+        return;
+    }
+    std::unique_ptr<SharemindTdbError> e(new SharemindTdbError(code));
+    if (errors->set(errors,
+                    dsName,
+                    e.get(),
+                    [](void * p) { delete static_cast<SharemindTdbError *>(p); }))
+        e.release();
+}
+
+SharemindTdbVectorMap * getMap(SharemindModuleApi0x1SyscallContext * c,
+                               std::uint64_t const vmapId)
+{
+    SharemindDataStore * const store =
+            processDataStore(c, "mod_tabledb/vector_maps");
+    if (!store)
+        return nullptr;
+    auto & util = mockDb(c).mapUtil();
+    return util.get_map(&util, store, vmapId);
+}
+
+SharemindTdbVectorMap * newMap(SharemindModuleApi0x1SyscallContext * c) {
+    SharemindDataStore * const store =
+            processDataStore(c, "mod_tabledb/vector_maps");
+    if (!store)
+        return nullptr;
+    auto & util = mockDb(c).mapUtil();
+    return util.new_map(&util, store);
+}
+
+void deleteMap(SharemindModuleApi0x1SyscallContext * c,
+               SharemindTdbVectorMap * map)
+{
+    SharemindDataStore * const store =
+            processDataStore(c, "mod_tabledb/vector_maps");
+    auto & util = mockDb(c).mapUtil();
+    util.delete_map(&util, store, map->get_id(map));
+}
+
+bool haveNtcsRefs(SharemindModuleApi0x1CReference const * crefs,
+                  std::size_t const n) noexcept
+{
+    for (std::size_t i = 0u; i < n; ++i)
+        if (!crefs[i].pData
+            || !crefs[i].size
+            || static_cast<char const *>(crefs[i].pData)[crefs[i].size - 1u])
+            return false;
+    return true;
+}
+
+std::string refToString(SharemindModuleApi0x1CReference const & ref) {
+    return std::string(static_cast<char const *>(ref.pData), ref.size - 1u);
+}
+
+MockDb::Tables::key_type tableKey(SharemindModuleApi0x1CReference const * crefs)
+{ return {refToString(crefs[0u]), refToString(crefs[1u])}; }
+
+bool sameType(Column const & column, SharemindTdbType const & type) noexcept {
+    return column.typeSize == type.size
+           && column.typeDomain == type.domain
+           && column.typeName == type.name;
+}
+
+SharemindModuleApi0x1Error createTable(SharemindCodeBlock * args,
+                                       std::size_t num_args,
+                                       SharemindModuleApi0x1CReference const * crefs,
+                                       SharemindModuleApi0x1SyscallContext * c)
+{
+    if (num_args != 1u || !crefs || !haveNtcsRefs(crefs, 2u))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+    auto const dsName = static_cast<char const *>(crefs[0u].pData);
+
+    SharemindTdbVectorMap * const params = getMap(c, args[0u].uint64[0u]);
+    if (!params)
+        return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+    SharemindTdbType ** types;
+    SharemindTdbString ** names;
+    std::size_t numTypes;
+    std::size_t numNames;
+    if (params->get_type_vector(params, "types", &types, &numTypes)
+            != TDB_VECTOR_MAP_OK
+        || params->get_string_vector(params, "names", &names, &numNames)
+            != TDB_VECTOR_MAP_OK
+        || numTypes != numNames
+        || !numTypes)
+    {
+        setErrorCode(c, dsName, SHAREMIND_TDB_INVALID_ARGUMENT);
+        return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+    }
+
+    Table table;
+    table.columns.reserve(numTypes);
+    for (std::size_t i = 0u; i < numTypes; ++i)
+        table.columns.emplace_back(Column{names[i]->str,
+                                          types[i]->domain,
+                                          types[i]->name,
+                                          types[i]->size,
+                                          {},
+                                          {0u}});
+
+    auto & db = mockDb(c);
+    std::lock_guard<std::mutex> const guard(db.mutex());
+    if (!db.tables().emplace(tableKey(crefs), std::move(table)).second) {
+        setErrorCode(c, dsName, SHAREMIND_TDB_TABLE_ALREADY_EXISTS);
+        return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+    }
+    setErrorCode(c, dsName, SHAREMIND_TDB_OK);
+    return SHAREMIND_MODULE_API_0x1_OK;
+}
+
+/**
+  Calls f(table) with the table named by the first two constant references
+  while holding the database mutex, and sets the error code of the call.
+*/
+template <typename F>
+SharemindModuleApi0x1Error withTable(SharemindModuleApi0x1CReference const * crefs,
+                                     SharemindModuleApi0x1SyscallContext * c,
+                                     F && f)
+{
+    if (!crefs || !haveNtcsRefs(crefs, 2u))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+    auto const dsName = static_cast<char const *>(crefs[0u].pData);
+
+    auto & db = mockDb(c);
+    std::lock_guard<std::mutex> const guard(db.mutex());
+    auto const it(db.tables().find(tableKey(crefs)));
+    if (it == db.tables().end()) {
+        setErrorCode(c, dsName, SHAREMIND_TDB_TABLE_NOT_FOUND);
+        return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+    }
+    SharemindTdbError const e = f(it->second);
+    setErrorCode(c, dsName, e);
+    return (e == SHAREMIND_TDB_OK)
+           ? SHAREMIND_MODULE_API_0x1_OK
+           : SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+}
+
+SharemindModuleApi0x1Error insertRow(SharemindCodeBlock * args,
+                                     std::size_t num_args,
+                                     SharemindModuleApi0x1CReference const * crefs,
+                                     SharemindModuleApi0x1SyscallContext * c)
+{
+    // tdb_insert_row2 takes whether values are given as columns, unsupported:
+    if (num_args < 1u || num_args > 2u
+        || (num_args == 2u && args[1u].uint8[0u]))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    SharemindTdbVectorMap * const params = getMap(c, args[0u].uint64[0u]);
+    if (!params)
+        return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+
+    return withTable(crefs, c, [params](Table & table) {
+        std::size_t batches;
+        if (params->batch_count(params, &batches) != TDB_VECTOR_MAP_OK)
+            return SHAREMIND_TDB_GENERAL_ERROR;
+
+        // Every batch holds the values of a row:
+        for (std::size_t b = 0u; b < batches; ++b) {
+            SharemindTdbValue ** values;
+            std::size_t size;
+            if (params->set_batch(params, b) != TDB_VECTOR_MAP_OK
+                || params->get_value_vector(params, "values", &values, &size)
+                    != TDB_VECTOR_MAP_OK
+                || size != table.columns.size())
+                return SHAREMIND_TDB_INVALID_ARGUMENT;
+            for (std::size_t i = 0u; i < size; ++i)
+                if (!sameType(table.columns[i], *values[i]->type))
+                    return SHAREMIND_TDB_INVALID_ARGUMENT;
+            for (std::size_t i = 0u; i < size; ++i) {
+                auto & column = table.columns[i];
+                auto const * const data =
+                        static_cast<unsigned char const *>(values[i]->buffer);
+                column.payload.insert(column.payload.end(),
+                                      data,
+                                      data + values[i]->size);
+                column.offsets.push_back(column.payload.size());
+            }
+            ++table.rows;
+        }
+        params->set_batch(params, 0u);
+        return SHAREMIND_TDB_OK;
+    });
+}
+
+SharemindModuleApi0x1Error returnStrings(SharemindModuleApi0x1SyscallContext * c,
+                                         std::vector<std::string> const & strings,
+                                         SharemindCodeBlock * returnValue)
+{
+    SharemindTdbVectorMap * const map = newMap(c);
+    if (!map)
+        return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+    auto * const array = new SharemindTdbString *[strings.size()];
+    for (std::size_t i = 0u; i < strings.size(); ++i)
+        array[i] = SharemindTdbString_new2(strings[i].c_str(),
+                                           strings[i].size());
+    if (map->set_string_vector(map, "names", array, strings.size())
+            != TDB_VECTOR_MAP_OK)
+    {
+        for (std::size_t i = 0u; i < strings.size(); ++i)
+            SharemindTdbString_delete(array[i]);
+        delete[] array;
+        deleteMap(c, map);
+        return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+    }
+    returnValue->uint64[0u] = map->get_id(map);
+    return SHAREMIND_MODULE_API_0x1_OK;
+}
+
+void releaseBuffer(void * buffer) { ::operator delete(buffer); }
+
+} // anonymous namespace
+
+extern "C" {
+
+SHAREMIND_MODULE_API_MODULE_INFO("tabledb_mock",
+                                 0x00010000,
+                                 0x1);
+
+SHAREMIND_MODULE_API_0x1_INITIALIZER(c) __attribute__ ((visibility("default")));
+SHAREMIND_MODULE_API_0x1_INITIALIZER(c) {
+    assert(c);
+    const SharemindModuleApi0x1Facility * const fmapUtil =
+            c->getModuleFacility(c, "TdbVectorMapUtil");
+    if (!fmapUtil || !fmapUtil->facility)
+        return SHAREMIND_MODULE_API_0x1_MISSING_FACILITY;
+    try {
+        c->moduleHandle = new MockDb(
+                *static_cast<SharemindTdbVectorMapUtil *>(fmapUtil->facility));
+        return SHAREMIND_MODULE_API_0x1_OK;
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    }
+}
+
+SHAREMIND_MODULE_API_0x1_DEINITIALIZER(c) __attribute__ ((visibility("default")));
+SHAREMIND_MODULE_API_0x1_DEINITIALIZER(c) {
+    assert(c);
+    delete static_cast<MockDb *>(c->moduleHandle);
+    c->moduleHandle = nullptr;
+}
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_open,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    (void) args; (void) refs; (void) returnValue;
+    if (num_args || !crefs || !haveNtcsRefs(crefs, 1u))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+    setErrorCode(c, static_cast<char const *>(crefs[0u].pData), SHAREMIND_TDB_OK);
+    return SHAREMIND_MODULE_API_0x1_OK;
+}
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_close,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{ return tdb_open(args, num_args, refs, crefs, returnValue, c); }
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_table_names,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    (void) args; (void) refs;
+    if (num_args || !returnValue || !crefs || !haveNtcsRefs(crefs, 1u))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+    try {
+        auto const dsName(refToString(crefs[0u]));
+        std::vector<std::string> names;
+        {
+            auto & db = mockDb(c);
+            std::lock_guard<std::mutex> const guard(db.mutex());
+            for (auto const & table : db.tables())
+                if (table.first.first == dsName)
+                    names.push_back(table.first.second);
+        }
+        setErrorCode(c, dsName.c_str(), SHAREMIND_TDB_OK);
+        return returnStrings(c, names, returnValue);
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    }
+}
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_tbl_create2,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    (void) refs; (void) returnValue;
+    try {
+        return createTable(args, num_args, crefs, c);
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    }
+}
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_tbl_create,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{ return tdb_tbl_create2(args, num_args, refs, crefs, returnValue, c); }
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_tbl_delete,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    (void) args; (void) refs; (void) returnValue;
+    if (num_args || !crefs || !haveNtcsRefs(crefs, 2u))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+    try {
+        auto & db = mockDb(c);
+        std::lock_guard<std::mutex> const guard(db.mutex());
+        auto const dsName = static_cast<char const *>(crefs[0u].pData);
+        if (!db.tables().erase(tableKey(crefs))) {
+            setErrorCode(c, dsName, SHAREMIND_TDB_TABLE_NOT_FOUND);
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+        }
+        setErrorCode(c, dsName, SHAREMIND_TDB_OK);
+        return SHAREMIND_MODULE_API_0x1_OK;
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    }
+}
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_tbl_exists,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    (void) args; (void) refs;
+    if (num_args || !returnValue || !crefs || !haveNtcsRefs(crefs, 2u))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+    try {
+        auto & db = mockDb(c);
+        std::lock_guard<std::mutex> const guard(db.mutex());
+        returnValue->uint64[0u] = db.tables().count(tableKey(crefs));
+        setErrorCode(c,
+                     static_cast<char const *>(crefs[0u].pData),
+                     SHAREMIND_TDB_OK);
+        return SHAREMIND_MODULE_API_0x1_OK;
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    }
+}
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_tbl_col_count,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    (void) args; (void) refs;
+    if (num_args || !returnValue)
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+    try {
+        return withTable(crefs, c, [returnValue](Table & table) {
+            returnValue->uint64[0u] = table.columns.size();
+            return SHAREMIND_TDB_OK;
+        });
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    }
+}
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_tbl_row_count,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    (void) args; (void) refs;
+    if (num_args || !returnValue)
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+    try {
+        return withTable(crefs, c, [returnValue](Table & table) {
+            returnValue->uint64[0u] = table.rows;
+            return SHAREMIND_TDB_OK;
+        });
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    }
+}
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_tbl_col_names,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    (void) args; (void) refs;
+    if (num_args || !returnValue)
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+    try {
+        std::vector<std::string> names;
+        auto const r = withTable(crefs, c, [&names](Table & table) {
+            for (auto const & column : table.columns)
+                names.push_back(column.name);
+            return SHAREMIND_TDB_OK;
+        });
+        return (r == SHAREMIND_MODULE_API_0x1_OK)
+               ? returnStrings(c, names, returnValue)
+               : r;
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    }
+}
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_tbl_col_types,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    (void) args; (void) refs;
+    if (num_args || !returnValue)
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+    try {
+        std::vector<Column> columns;
+        auto const r = withTable(crefs, c, [&columns](Table & table) {
+            for (auto const & column : table.columns)
+                columns.push_back(Column{column.name,
+                                         column.typeDomain,
+                                         column.typeName,
+                                         column.typeSize,
+                                         {},
+                                         {0u}});
+            return SHAREMIND_TDB_OK;
+        });
+        if (r != SHAREMIND_MODULE_API_0x1_OK)
+            return r;
+
+        SharemindTdbVectorMap * const map = newMap(c);
+        if (!map)
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+        auto * const array = new SharemindTdbType *[columns.size()];
+        for (std::size_t i = 0u; i < columns.size(); ++i)
+            array[i] = SharemindTdbType_new(columns[i].typeDomain.c_str(),
+                                            columns[i].typeName.c_str(),
+                                            columns[i].typeSize);
+        if (map->set_type_vector(map, "types", array, columns.size())
+                != TDB_VECTOR_MAP_OK)
+        {
+            for (std::size_t i = 0u; i < columns.size(); ++i)
+                SharemindTdbType_delete(array[i]);
+            delete[] array;
+            deleteMap(c, map);
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+        }
+        returnValue->uint64[0u] = map->get_id(map);
+        return SHAREMIND_MODULE_API_0x1_OK;
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    }
+}
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_insert_row,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    (void) refs; (void) returnValue;
+    try {
+        return insertRow(args, num_args, crefs, c);
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    }
+}
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_insert_row2,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{ return tdb_insert_row(args, num_args, refs, crefs, returnValue, c); }
+
+/*
+  Takes the column index as an argument or the column name as the third
+  constant reference and returns a vector map with the column as the value
+  vector "values". The map references a copy of the column, so the column may
+  change while the map is in use.
+*/
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_read_col,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    (void) refs;
+    if (!returnValue || !crefs || !haveNtcsRefs(crefs, 2u))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+    bool const byName = crefs[2u].pData;
+    if (byName ? (num_args || !haveNtcsRefs(crefs + 2u, 1u)) : num_args != 1u)
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    try {
+        SharemindTdbVectorMap * const map = newMap(c);
+        if (!map)
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+        auto const r = withTable(crefs, c, [&](Table & table) {
+            std::size_t i = 0u;
+            if (byName) {
+                auto const name(refToString(crefs[2u]));
+                while (i < table.columns.size()
+                       && table.columns[i].name != name)
+                    ++i;
+            } else {
+                i = args[0u].uint64[0u];
+            }
+            if (i >= table.columns.size())
+                return SHAREMIND_TDB_INVALID_ARGUMENT;
+
+            auto const & column = table.columns[i];
+            SharemindTdbType const type{
+                    const_cast<char *>(column.typeDomain.c_str()),
+                    const_cast<char *>(column.typeName.c_str()),
+                    column.typeSize};
+            void * const buffer = ::operator new(column.payload.size());
+            if (!column.payload.empty())
+                std::memcpy(buffer,
+                            column.payload.data(),
+                            column.payload.size());
+            if (map->set_external_value_vector(map,
+                                               "values",
+                                               &type,
+                                               buffer,
+                                               column.offsets.data(),
+                                               table.rows,
+                                               &releaseBuffer,
+                                               buffer)
+                    != TDB_VECTOR_MAP_OK)
+            {
+                releaseBuffer(buffer);
+                return SHAREMIND_TDB_GENERAL_ERROR;
+            }
+            return SHAREMIND_TDB_OK;
+        });
+        if (r != SHAREMIND_MODULE_API_0x1_OK) {
+            deleteMap(c, map);
+            return r;
+        }
+        returnValue->uint64[0u] = map->get_id(map);
+        return SHAREMIND_MODULE_API_0x1_OK;
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    }
+}
+
+/* Attributes are not supported: */
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_get_attributes,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    (void) args; (void) num_args; (void) refs; (void) returnValue;
+    if (!crefs || !haveNtcsRefs(crefs, 1u))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+    setErrorCode(c,
+                 static_cast<char const *>(crefs[0u].pData),
+                 SHAREMIND_TDB_GENERAL_ERROR);
+    return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+}
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_set_attributes,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{ return tdb_get_attributes(args, num_args, refs, crefs, returnValue, c); }
+
+SHAREMIND_MODULE_API_0x1_SYSCALL_DEFINITIONS(
+      { "tdb_open", &tdb_open }
+    , { "tdb_close", &tdb_close }
+    , { "tdb_table_names", &tdb_table_names }
+    , { "tdb_tbl_create", &tdb_tbl_create }
+    , { "tdb_tbl_create2", &tdb_tbl_create2 }
+    , { "tdb_tbl_delete", &tdb_tbl_delete }
+    , { "tdb_tbl_exists", &tdb_tbl_exists }
+    , { "tdb_tbl_col_count", &tdb_tbl_col_count }
+    , { "tdb_tbl_col_names", &tdb_tbl_col_names }
+    , { "tdb_tbl_col_types", &tdb_tbl_col_types }
+    , { "tdb_tbl_row_count", &tdb_tbl_row_count }
+    , { "tdb_insert_row", &tdb_insert_row }
+    , { "tdb_insert_row2", &tdb_insert_row2 }
+    , { "tdb_read_col", &tdb_read_col }
+    , { "tdb_get_attributes", &tdb_get_attributes }
+    , { "tdb_set_attributes", &tdb_set_attributes }
+);
+
+} /* extern "C" { */
@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+
+#ifndef SHAREMIND_MOD_TABLEDB_MOCK_STANDINDATASTORE_H
+#define SHAREMIND_MOD_TABLEDB_MOCK_STANDINDATASTORE_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <sharemind/datastoreapi.h>
+#include <string>
+#include <utility>
+
+
+namespace sharemind {
+namespace mock {
+
+/**
+  \brief An in-process SharemindDataStore for running the module without the
+         Sharemind runtime.
+
+  Lookups by C string do not allocate. The cleaners of the values are called
+  when they are replaced, removed or cleared, and when the store is destroyed.
+*/
+class StandInDataStore: public ::SharemindDataStore {
+
+private: /* Types: */
+
+    struct Entry {
+        void * value;
+        SharemindDataStoreCleaner cleaner;
+    };
+
+    using Map = std::map<std::string, Entry, std::less<> >;
+
+public: /* Methods: */
+
+    StandInDataStore()
+        : ::SharemindDataStore{&StandInDataStore::get_,
+                               &StandInDataStore::set_,
+                               &StandInDataStore::remove_,
+                               &StandInDataStore::clear_}
+    {}
+
+    StandInDataStore(StandInDataStore const &) = delete;
+    StandInDataStore & operator=(StandInDataStore const &) = delete;
+
+    ~StandInDataStore() noexcept { clear(); }
+
+    void * get(char const * const key) const noexcept {
+        auto const it(m_values.find(key));
+        return (it != m_values.end()) ? it->second.value : nullptr;
+    }
+
+    bool set(char const * const key,
+             void * const value,
+             SharemindDataStoreCleaner const cleaner)
+    {
+        auto const it(m_values.find(key));
+        if (it == m_values.end()) {
+            m_values.emplace(key, Entry{value, cleaner});
+            return true;
+        }
+        Entry const old(it->second);
+        it->second = Entry{value, cleaner};
+        if (old.cleaner)
+            old.cleaner(old.value);
+        return true;
+    }
+
+    bool remove(char const * const key) noexcept {
+        auto const it(m_values.find(key));
+        if (it == m_values.end())
+            return false;
+        Entry const old(it->second);
+        m_values.erase(it);
+        if (old.cleaner)
+            old.cleaner(old.value);
+        return true;
+    }
+
+    void clear() noexcept {
+        while (!m_values.empty()) {
+            auto const it(m_values.begin());
+            Entry const old(it->second);
+            m_values.erase(it);
+            if (old.cleaner)
+                old.cleaner(old.value);
+        }
+    }
+
+    std::size_t size() const noexcept { return m_values.size(); }
+
+private: /* Methods: */
+
+    static StandInDataStore & self(::SharemindDataStore * store) noexcept
+    { return *static_cast<StandInDataStore *>(store); }
+
+    static void * get_(::SharemindDataStore * store, char const * key)
+    { return self(store).get(key); }
+
+    static bool set_(::SharemindDataStore * store,
+                     char const * key,
+                     void * value,
+                     SharemindDataStoreCleaner cleaner)
+    {
+        try {
+            return self(store).set(key, value, cleaner);
+        } catch (...) {
+            return false;
+        }
+    }
+
+    static bool remove_(::SharemindDataStore * store, char const * key)
+    { return self(store).remove(key); }
+
+    static void clear_(::SharemindDataStore * store)
+    { self(store).clear(); }
+
+private: /* Fields: */
+
+    Map m_values;
+
+}; /* class StandInDataStore { */
+
+/**
+  \brief An in-process SharemindDataStoreFactory holding the data stores of
+         a single process.
+*/
+class StandInDataStoreFactory: public ::SharemindDataStoreFactory {
+
+public: /* Methods: */
+
+    StandInDataStoreFactory()
+        : ::SharemindDataStoreFactory{&StandInDataStoreFactory::get_datastore_}
+    {}
+
+    StandInDataStoreFactory(StandInDataStoreFactory const &) = delete;
+    StandInDataStoreFactory & operator=(StandInDataStoreFactory const &) =
+            delete;
+
+    /** \brief Destroys the data stores, like the end of a process does. */
+    ~StandInDataStoreFactory() noexcept { clear(); }
+
+    StandInDataStore * dataStore(char const * const name) {
+        auto it(m_dataStores.find(name));
+        if (it == m_dataStores.end())
+            it = m_dataStores.emplace(
+                     name,
+                     std::unique_ptr<StandInDataStore>(
+                         new StandInDataStore)).first;
+        return it->second.get();
+    }
+
+    void clear() noexcept {
+        for (auto & store : m_dataStores)
+            store.second->clear();
+        m_dataStores.clear();
+    }
+
+private: /* Methods: */
+
+    static ::SharemindDataStore * get_datastore_(
+            ::SharemindDataStoreFactory * factory,
+            char const * name)
+    {
+        try {
+            return static_cast<StandInDataStoreFactory *>(factory)
+                    ->dataStore(name);
+        } catch (...) {
+            return nullptr;
+        }
+    }
+
+private: /* Fields: */
+
+    std::map<std::string,
+             std::unique_ptr<StandInDataStore>,
+             std::less<> > m_dataStores;
+
+}; /* class StandInDataStoreFactory { */
+
+} /* namespace mock { */
+} /* namespace sharemind { */
+
+#endif /* SHAREMIND_MOD_TABLEDB_MOCK_STANDINDATASTORE_H */
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+
+#ifndef SHAREMIND_MOD_TABLEDB_MOCK_STANDINPROCESS_H
+#define SHAREMIND_MOD_TABLEDB_MOCK_STANDINPROCESS_H
+
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <sharemind/AccessControlProcessFacility.h>
+#include <sharemind/libprocessfacility.h>
+#include <sharemind/module-apis/api_0x1.h>
+#include <string>
+#include "StandInDataStore.h"
+
+
+namespace sharemind {
+namespace mock {
+
+/**
+  \brief An access control facility whose policy allows every program to use
+         every data source and table.
+*/
+class AllowAllAccessControlProcessFacility final
+    : public AccessControlProcessFacility
+{
+
+public: /* Methods: */
+
+    AllowAllAccessControlProcessFacility()
+        : m_permissions(std::make_shared<ObjectPermissions>())
+    {
+        // The wildcards checked last for data sources and tables:
+        m_permissions->emplace("*:*", AccessResult::Allowed);
+        m_permissions->emplace("*:*:*:*", AccessResult::Allowed);
+    }
+
+    std::shared_ptr<ObjectPermissions const> getCurrentPermissions(
+            PreparedPredicate const &) const final override
+    { return m_permissions; }
+
+private: /* Fields: */
+
+    std::shared_ptr<ObjectPermissions> const m_permissions;
+
+}; /* class AllowAllAccessControlProcessFacility { */
+
+/**
+  \brief The facilities and data stores of a stand-in process, handed to the
+         syscalls of a module by the syscall contexts it creates.
+
+  Only one stand-in process may exist at a time, because the syscall context
+  has no public field to find the process by.
+*/
+class StandInProcess {
+
+public: /* Methods: */
+
+    explicit StandInProcess(std::string programName = "stand-in")
+        : m_programName(std::move(programName))
+    {
+        assert(!instance());
+        instance() = this;
+    }
+
+    ~StandInProcess() noexcept {
+        end();
+        instance() = nullptr;
+    }
+
+    StandInProcess(StandInProcess const &) = delete;
+    StandInProcess & operator=(StandInProcess const &) = delete;
+
+    /** \returns a context for calling syscalls of the given module. */
+    SharemindModuleApi0x1SyscallContext context(void * const moduleHandle)
+            noexcept
+    {
+        // The stand-in provides no memory to the syscalls:
+        #pragma GCC diagnostic push
+        #pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+        return SharemindModuleApi0x1SyscallContext{
+                    moduleHandle,
+                    nullptr,
+                    nullptr,
+                    &StandInProcess::processFacility_};
+        #pragma GCC diagnostic pop
+    }
+
+    StandInDataStoreFactory & dataStores() noexcept { return m_dataStores; }
+
+    /** \brief Destroys the data stores, like the end of the process does. */
+    void end() noexcept { m_dataStores.clear(); }
+
+private: /* Types: */
+
+    struct ProcessFacility: ::SharemindProcessFacility {
+        ProcessFacility() noexcept
+            : ::SharemindProcessFacility{&StandInProcess::programName_}
+        {}
+    };
+
+private: /* Methods: */
+
+    static StandInProcess *& instance() noexcept {
+        static StandInProcess * process = nullptr;
+        return process;
+    }
+
+    static void * processFacility_(SharemindModuleApi0x1SyscallContext const *,
+                                   char const * name)
+    {
+        assert(instance());
+        auto & self = *instance();
+        if (!std::strcmp(name, "DataStoreFactory"))
+            return static_cast<::SharemindDataStoreFactory *>(
+                        &self.m_dataStores);
+        if (!std::strcmp(name, "ProcessFacility"))
+            return static_cast<::SharemindProcessFacility *>(
+                        &self.m_processFacility);
+        if (!std::strcmp(name, "AccessControlProcessFacility"))
+            return static_cast<AccessControlProcessFacility *>(
+                        &self.m_aclFacility);
+        return nullptr;
+    }
+
+    static char const * programName_(::SharemindProcessFacility const *) {
+        assert(instance());
+        return instance()->m_programName.c_str();
+    }
+
+private: /* Fields: */
+
+    ProcessFacility m_processFacility;
+    std::string const m_programName;
+    AllowAllAccessControlProcessFacility m_aclFacility;
+    StandInDataStoreFactory m_dataStores;
+
+}; /* class StandInProcess { */
+
+} /* namespace mock { */
+} /* namespace sharemind { */
+
+#endif /* SHAREMIND_MOD_TABLEDB_MOCK_STANDINPROCESS_H */
@@ -20,8 +20,16 @@
 #ifndef SHAREMIND_MOD_TABLEDB_DATASOURCE_H
 #define SHAREMIND_MOD_TABLEDB_DATASOURCE_H
 
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <sharemind/dbcommon/datasourceapi.h>
+#include <sharemind/libmodapi/libmodapi.h>
 #include <string>
+#include <vector>
+#include "TdbStatistics.h"
+#include "TdbTableCache.h"
 
 
 namespace sharemind  {
@@ -47,6 +55,55 @@ public: /* Methods: */
     inline std::string & conf() { return m_conf; }
     inline const std::string & conf() const { return m_conf; }
 
+    /**
+      \brief Sets the pre-resolved syscalls of the database module of this
+             data source, indexed like the module loader signatures.
+    */
+    inline void setSyscallTable(
+            std::vector<SharemindSyscallWrapper> const * syscalls) noexcept
+    { m_syscalls = syscalls; }
+
+    inline SharemindSyscallWrapper syscall(std::size_t const index)
+            const noexcept
+    {
+        assert(m_syscalls);
+        assert(index < m_syscalls->size());
+        return (*m_syscalls)[index];
+    }
+
+    /**
+      \brief Sets the bitmap of the optional syscalls provided by the database
+             module of this data source.
+    */
+    inline void setCapabilities(std::uint64_t const capabilities) noexcept
+    { m_capabilities = capabilities; }
+
+    inline std::uint64_t capabilities() const noexcept
+    { return m_capabilities; }
+
+    /**
+      \brief Sets the statistics of the forwarded syscalls of this data source,
+             indexed like the module loader signatures.
+    */
+    inline void setStatistics(TdbDataSourceSyscallStatistics * statistics)
+            noexcept
+    { m_statistics = statistics; }
+
+    inline TdbDataSourceSyscallStatistics & statistics(
+            std::size_t const index) const noexcept
+    {
+        assert(m_statistics);
+        return m_statistics[index];
+    }
+
+    /** \brief Enables caching the results of table queries. */
+    inline void enableTableCache()
+    { m_tableCache.reset(new TdbTableCache); }
+
+    /** \returns the table cache or nullptr if caching is disabled. */
+    inline TdbTableCache * tableCache() const noexcept
+    { return m_tableCache.get(); }
+
     static DataSource & fromWrapper(Wrapper & wrapper) noexcept
     { return static_cast<DataSource &>(wrapper); }
 
@@ -58,6 +115,10 @@ private: /* Fields: */
     std::string m_name;
     std::string m_module;
     std::string m_conf;
+    std::vector<SharemindSyscallWrapper> const * m_syscalls = nullptr;
+    TdbDataSourceSyscallStatistics * m_statistics = nullptr;
+    std::uint64_t m_capabilities = 0u;
+    std::unique_ptr<TdbTableCache> m_tableCache;
 
 }; /* class DataSource { */
 
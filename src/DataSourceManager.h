@@ -20,10 +20,12 @@
 #ifndef SHAREMIND_MOD_TABLEDB_DATASOURCEMANAGER_H
 #define SHAREMIND_MOD_TABLEDB_DATASOURCEMANAGER_H
 
+#include <boost/utility/string_view.hpp>
 #include <map>
 #include <memory>
 #include <sharemind/dbcommon/datasourceapi.h>
 #include <sharemind/SimpleUnorderedStringMap.h>
+#include <sharemind/StringHashTablePredicate.h>
 #include <string>
 #include "DataSource.h"
 
@@ -57,6 +59,10 @@ public: /* Methods: */
         return (it != m_dataSources.end()) ? it->second.get() : nullptr;
     }
 
+    /** \brief Looks up a data source without copying its name. */
+    DataSource * getDataSource(boost::string_view const name) const
+    { return getDataSource(getOrCreateTemporaryStringHashTablePredicate(name)); }
+
     static DataSourceManager & fromWrapper(Wrapper & wrapper) noexcept
     { return static_cast<DataSourceManager &>(wrapper); }
 
@@ -22,10 +22,11 @@
 
 #include <algorithm>
 #include <cassert>
+#include <climits>
+#include <cstdint>
 #include <cstring>
 #include <LogHard/Logger.h>
 #include <memory>
-#include <sharemind/DebugOnly.h>
 #include <sharemind/libmodapi/libmodapi.h>
 #include <sharemind/likely.h>
 #include <sharemind/SimpleUnorderedStringMap.h>
@@ -37,18 +38,33 @@ namespace sharemind {
 
 class __attribute__ ((visibility("internal"))) ModuleLoader {
 
-private: /* Types: */
+public: /* Types: */
+
+    /**
+      Syscall wrappers of a module, indexed like the required signatures
+      followed by the optional signatures. Optional syscalls not provided by
+      the module have a null callable.
+    */
+    using SyscallTable = std::vector<SharemindSyscallWrapper>;
 
-    using SyscallMap =
-            SimpleUnorderedStringMap<std::unique_ptr<SharemindSyscallWrapper> >;
+    /** Bit i is set if a module provides the i-th optional signature. */
+    using Capabilities = std::uint64_t;
 
 public: /* Methods: */
 
     ModuleLoader(std::vector<std::string> requiredSyscallSignatures,
+                 std::vector<std::string> optionalSyscallSignatures,
                  LogHard::Logger const & logger)
-        : m_reqSignatures(std::move(requiredSyscallSignatures))
+        : m_signatures(std::move(requiredSyscallSignatures))
+        , m_numRequired(m_signatures.size())
         , m_logger(logger, "ModuleLoader:")
     {
+        assert(optionalSyscallSignatures.size()
+               <= sizeof(Capabilities) * CHAR_BIT);
+        m_signatures.insert(m_signatures.end(),
+                            optionalSyscallSignatures.begin(),
+                            optionalSyscallSignatures.end());
+
         /// \todo Throw a better exception
         m_modApi = SharemindModuleApi_new(nullptr, nullptr, nullptr);
         if (unlikely(!m_modApi))
@@ -98,24 +114,32 @@ public: /* Methods: */
             }
 
             /* Load system calls */
-            SyscallMap syscallMap;
-            for (auto const & required : m_reqSignatures) {
+            LoadedModule loaded;
+            auto & syscallTable = loaded.syscalls;
+            syscallTable.reserve(m_signatures.size());
+            for (std::size_t i = 0u; i < m_signatures.size(); ++i) {
+                auto const & signature = m_signatures[i];
                 auto * const sc =
-                        SharemindModule_findSyscall(m, required.c_str());
-                if (!sc) {
-                    m_logger.fatal() << "Required system call \"" << required
+                        SharemindModule_findSyscall(m, signature.c_str());
+                if (sc) {
+                    syscallTable.emplace_back(SharemindSyscall_wrapper(sc));
+                    if (i >= m_numRequired)
+                        loaded.capabilities |=
+                                Capabilities(1u) << (i - m_numRequired);
+                } else if (i < m_numRequired) {
+                    m_logger.fatal() << "Required system call \"" << signature
                                      << "\" not defined in module!";
                     throw GracefulException();
+                } else {
+                    m_logger.info() << "Optional system call \"" << signature
+                                    << "\" not defined in module \""
+                                    << moduleName << "\".";
+                    syscallTable.emplace_back(
+                                SharemindSyscallWrapper{nullptr, nullptr});
                 }
-                SHAREMIND_DEBUG_ONLY(auto const rv =)
-                        syscallMap.emplace(
-                            required,
-                            std::make_unique<SharemindSyscallWrapper>(
-                                SharemindSyscall_wrapper(sc)));
-                assert(rv.second);
             }
             auto rv = m_moduleSyscallMap.emplace(moduleName,
-                                                 std::move(syscallMap));
+                                                 std::move(loaded));
             assert(rv.second);
             try {
                 m_modules.push_back(m);
@@ -138,19 +162,30 @@ public: /* Methods: */
     bool hasModule(std::string const & module) const
     { return m_moduleSyscallMap.find(module) != m_moduleSyscallMap.end(); }
 
-    SharemindSyscallWrapper getSyscall(std::string const & module,
-                                       std::string const & signature) const
-    {
+    /**
+      \returns the syscall table of the given module or nullptr if no such
+               module is loaded. The table remains valid for the lifetime of
+               the loader.
+    */
+    SyscallTable const * syscallTable(std::string const & module) const {
         auto const msit(m_moduleSyscallMap.find(module));
-        if (msit == m_moduleSyscallMap.end())
-            return { nullptr, nullptr };
+        return (msit != m_moduleSyscallMap.end())
+               ? &msit->second.syscalls
+               : nullptr;
+    }
 
-        auto const & syscallMap = msit->second;
-        auto const sit = syscallMap.find(signature);
-        if (sit == syscallMap.end())
-            return { nullptr, nullptr };
+    /** \returns the optional signatures the given loaded module provides. */
+    Capabilities capabilities(std::string const & module) const {
+        auto const msit(m_moduleSyscallMap.find(module));
+        assert(msit != m_moduleSyscallMap.end());
+        return msit->second.capabilities;
+    }
+
+    std::size_t numSignatures() const noexcept { return m_signatures.size(); }
 
-        return *(sit->second);
+    std::string const & signature(std::size_t const index) const noexcept {
+        assert(index < m_signatures.size());
+        return m_signatures[index];
     }
 
     void setModuleFacility(char const * name,
@@ -171,13 +206,21 @@ public: /* Methods: */
         return SharemindModuleApi_moduleFacility(m_modApi, name);
     }
 
+private: /* Types: */
+
+    struct LoadedModule {
+        SyscallTable syscalls;
+        Capabilities capabilities = 0u;
+    };
+
 private: /* Fields: */
 
     std::vector<SharemindModule *> m_modules;
     SharemindModuleApi * m_modApi;
-    SimpleUnorderedStringMap<SyscallMap> m_moduleSyscallMap;
+    SimpleUnorderedStringMap<LoadedModule> m_moduleSyscallMap;
 
-    std::vector<std::string> m_reqSignatures;
+    std::vector<std::string> m_signatures;
+    std::size_t const m_numRequired;
 
     LogHard::Logger const m_logger;
 
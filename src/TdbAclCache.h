@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SHAREMIND_MOD_TABLEDB_TDBACLCACHE_H
+#define SHAREMIND_MOD_TABLEDB_TDBACLCACHE_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+
+
+namespace sharemind {
+
+/**
+  \brief Per-process cache of table access decisions.
+
+  Decisions are keyed by (data source, table, permission) and are only valid
+  for the permissions object they were made with. Whenever the access control
+  facility hands out a different permissions object, i.e. the policy of the
+  process has changed, all cached decisions are dropped.
+*/
+class __attribute__ ((visibility("internal"))) TdbAclCache {
+
+private: /* Types: */
+
+    using Key = std::tuple<std::string, std::string, std::string>;
+
+public: /* Methods: */
+
+    /**
+      \brief Drops all decisions if they were made with other permissions.
+      \param[in] permissions the current permissions of the process.
+    */
+    void validate(std::shared_ptr<void const> permissions) noexcept {
+        if (permissions != m_permissions) {
+            m_decisions.clear();
+            m_permissions = std::move(permissions);
+        }
+    }
+
+    /** \returns a pointer to the cached decision or nullptr if none. */
+    template <typename Ds, typename Tbl, typename Perm>
+    bool const * find(Ds const & ds, Tbl const & tbl, Perm const & perm)
+            const
+    {
+        auto const it(m_decisions.find(std::tie(ds, tbl, perm)));
+        return (it != m_decisions.end()) ? &it->second : nullptr;
+    }
+
+    void insert(std::string ds,
+                std::string tbl,
+                std::string perm,
+                bool const allowed)
+    {
+        m_decisions.emplace(
+                    Key(std::move(ds), std::move(tbl), std::move(perm)),
+                    allowed);
+    }
+
+    void clear() noexcept {
+        m_decisions.clear();
+        m_permissions.reset();
+    }
+
+private: /* Fields: */
+
+    std::shared_ptr<void const> m_permissions;
+    std::map<Key, bool, std::less<> > m_decisions;
+
+}; /* class TdbAclCache { */
+
+} /* namespace sharemind { */
+
+#endif /* SHAREMIND_MOD_TABLEDB_TDBACLCACHE_H */
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "TdbAsyncExecutor.h"
+
+#include <cassert>
+#include <utility>
+
+
+namespace sharemind {
+
+TdbAsyncExecutor::TdbAsyncExecutor(std::size_t const maxWorkers)
+    : m_maxWorkers(maxWorkers)
+{ assert(maxWorkers > 0u); }
+
+TdbAsyncExecutor::~TdbAsyncExecutor() noexcept {
+    {
+        std::lock_guard<std::mutex> const guard(m_mutex);
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    for (auto & worker : m_workers)
+        worker.join();
+}
+
+void TdbAsyncExecutor::submit(std::string const & queue, Job job) {
+    std::lock_guard<std::mutex> const guard(m_mutex);
+    auto & q = m_queues[queue];
+    q.jobs.emplace_back(std::move(job));
+    if (q.scheduled)
+        return;
+
+    try {
+        m_ready.push_back(&q);
+        try {
+            if (!m_idleWorkers && m_workers.size() < m_maxWorkers) {
+                m_workers.emplace_back(&TdbAsyncExecutor::run, this);
+            } else {
+                m_cond.notify_one();
+            }
+        } catch (...) {
+            // The job can still be run by the running workers, if any:
+            if (m_workers.empty()) {
+                m_ready.pop_back();
+                throw;
+            }
+        }
+    } catch (...) {
+        q.jobs.pop_back();
+        throw;
+    }
+    q.scheduled = true;
+}
+
+void TdbAsyncExecutor::run() noexcept {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        while (m_ready.empty()) {
+            if (m_stop)
+                return;
+            ++m_idleWorkers;
+            m_cond.wait(lock);
+            --m_idleWorkers;
+        }
+
+        Queue & q = *m_ready.front();
+        m_ready.pop_front();
+        assert(q.scheduled);
+        assert(!q.jobs.empty());
+        Job job(std::move(q.jobs.front()));
+        q.jobs.pop_front();
+
+        lock.unlock();
+        job();
+        lock.lock();
+
+        // Keep the queue scheduled until all of its jobs have run:
+        if (q.jobs.empty()) {
+            q.scheduled = false;
+        } else {
+            m_ready.push_back(&q);
+        }
+    }
+}
+
+} /* namespace sharemind { */
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SHAREMIND_MOD_TABLEDB_TDBASYNCEXECUTOR_H
+#define SHAREMIND_MOD_TABLEDB_TDBASYNCEXECUTOR_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace sharemind {
+
+/**
+  \brief A bounded pool of worker threads running jobs from named queues.
+
+  Jobs submitted to the same queue run one at a time in submission order,
+  while jobs of different queues may run in parallel. Workers are started on
+  demand up to the given maximum.
+*/
+class __attribute__ ((visibility("internal"))) TdbAsyncExecutor {
+
+public: /* Types: */
+
+    /** \brief A job, which must not throw. */
+    using Job = std::function<void ()>;
+
+public: /* Methods: */
+
+    explicit TdbAsyncExecutor(std::size_t maxWorkers);
+
+    /** \brief Runs the remaining jobs and stops the workers. */
+    ~TdbAsyncExecutor() noexcept;
+
+    TdbAsyncExecutor(TdbAsyncExecutor const &) = delete;
+    TdbAsyncExecutor & operator=(TdbAsyncExecutor const &) = delete;
+
+    void submit(std::string const & queue, Job job);
+
+private: /* Types: */
+
+    struct Queue {
+        std::deque<Job> jobs;
+        bool scheduled = false;
+    };
+
+private: /* Methods: */
+
+    void run() noexcept;
+
+private: /* Fields: */
+
+    std::size_t const m_maxWorkers;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_stop = false;
+    std::size_t m_idleWorkers = 0u;
+    std::map<std::string, Queue> m_queues;
+    std::deque<Queue *> m_ready;
+    std::vector<std::thread> m_workers;
+
+}; /* class TdbAsyncExecutor { */
+
+} /* namespace sharemind { */
+
+#endif /* SHAREMIND_MOD_TABLEDB_TDBASYNCEXECUTOR_H */
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SHAREMIND_MOD_TABLEDB_TDBASYNCPROCESS_H
+#define SHAREMIND_MOD_TABLEDB_TDBASYNCPROCESS_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <sharemind/module-apis/api_0x1.h>
+#include <unordered_map>
+#include <utility>
+
+
+namespace sharemind {
+
+/** \brief The completion state of a syscall run by a worker. */
+class __attribute__ ((visibility("internal"))) TdbAsyncCall {
+
+public: /* Methods: */
+
+    void complete(SharemindModuleApi0x1Error const result,
+                  SharemindCodeBlock const & returnValue) noexcept
+    {
+        {
+            std::lock_guard<std::mutex> const guard(m_mutex);
+            m_result = result;
+            m_returnValue = returnValue;
+            m_done = true;
+        }
+        m_cond.notify_all();
+    }
+
+    bool done() const noexcept {
+        std::lock_guard<std::mutex> const guard(m_mutex);
+        return m_done;
+    }
+
+    /** \returns the result of the syscall after waiting for it to complete. */
+    SharemindModuleApi0x1Error wait(SharemindCodeBlock & returnValue) const
+            noexcept
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cond.wait(lock, [this]() noexcept { return m_done; });
+        returnValue = m_returnValue;
+        return m_result;
+    }
+
+private: /* Fields: */
+
+    mutable std::mutex m_mutex;
+    mutable std::condition_variable m_cond;
+    bool m_done = false;
+    SharemindModuleApi0x1Error m_result = SHAREMIND_MODULE_API_0x1_OK;
+    SharemindCodeBlock m_returnValue;
+
+}; /* class TdbAsyncCall { */
+
+/**
+  \brief The asynchronous syscalls of a process.
+
+  Once the process has made asynchronous calls, the process mutex is held by
+  the process while it runs syscalls of this module and by the workers while
+  they run syscalls on behalf of the process, since database modules access
+  the process data stores. The table of call handles is only accessed by the
+  process itself.
+*/
+class __attribute__ ((visibility("internal"))) TdbAsyncProcess {
+
+public: /* Methods: */
+
+    std::mutex & mutex() noexcept { return m_mutex; }
+
+    /** \returns whether the process has made asynchronous calls. */
+    bool used() const noexcept { return m_nextHandle != 1u; }
+
+    /** \returns the handle of the new call. */
+    std::uint64_t insert(std::shared_ptr<TdbAsyncCall> call) {
+        auto const handle = m_nextHandle;
+        m_calls.emplace(handle, std::move(call));
+        ++m_nextHandle;
+        return handle;
+    }
+
+    /** \returns the call with the given handle or nullptr. */
+    std::shared_ptr<TdbAsyncCall> find(std::uint64_t const handle) const {
+        auto const it(m_calls.find(handle));
+        return (it != m_calls.end()) ? it->second : nullptr;
+    }
+
+    bool erase(std::uint64_t const handle) noexcept
+    { return m_calls.erase(handle); }
+
+    /** \brief Waits for all calls which have not been waited for. */
+    void waitAll() const noexcept {
+        SharemindCodeBlock returnValue;
+        for (auto const & call : m_calls)
+            call.second->wait(returnValue);
+    }
+
+private: /* Fields: */
+
+    std::mutex m_mutex;
+    std::uint64_t m_nextHandle = 1u;
+    std::unordered_map<std::uint64_t, std::shared_ptr<TdbAsyncCall> > m_calls;
+
+}; /* class TdbAsyncProcess { */
+
+} /* namespace sharemind { */
+
+#endif /* SHAREMIND_MOD_TABLEDB_TDBASYNCPROCESS_H */
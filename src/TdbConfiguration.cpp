@@ -39,7 +39,23 @@ TdbConfiguration::TdbConfiguration(std::string const & filename) {
                     DataSourceEntry{
                         v.get<std::string>("Name"),
                         v.get<std::string>("DBModule"),
-                        v.get<std::string>("Configuration")});
+                        v.get<std::string>("Configuration"),
+                        v.get<bool>("TableCache", false)});
+        } else if (section == "Async") {
+            m_asyncWorkers = v.get<std::size_t>("Workers", m_asyncWorkers);
+        } else if (section == "VectorMaps") {
+            m_vectorMapMemoryQuota =
+                    v.get<std::uint64_t>("MemoryQuota",
+                                         m_vectorMapMemoryQuota);
+            m_vectorMapSpillThreshold =
+                    v.get<std::uint64_t>("SpillThreshold",
+                                         m_vectorMapSpillThreshold);
+            m_vectorMapSpillDirectory =
+                    v.get<std::string>("SpillDirectory",
+                                       m_vectorMapSpillDirectory);
+            m_vectorMapSnapshotDirectory =
+                    v.get<std::string>("SnapshotDirectory",
+                                       m_vectorMapSnapshotDirectory);
         }
     }
 }
@@ -20,6 +20,8 @@
 #ifndef SHAREMIND_MOD_TABLEDB_TDBCONFIGURATION_H
 #define SHAREMIND_MOD_TABLEDB_TDBCONFIGURATION_H
 
+#include <cstddef>
+#include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
@@ -41,6 +43,7 @@ public: /* Types: */
         std::string name;
         std::string dbModule;
         std::string configurationFile;
+        bool tableCache;
     };
     using DataSourceList = std::vector<DataSourceEntry>;
 
@@ -58,10 +61,44 @@ public: /* Methods: */
     inline DataSourceList const & dataSourceList() const
     { return m_dataSourceList; }
 
+    /** \returns the maximum number of workers running asynchronous calls. */
+    inline std::size_t asyncWorkers() const noexcept
+    { return m_asyncWorkers; }
+
+    /**
+      \returns the maximum number of bytes held by the vector maps of a
+               process or 0 if unlimited.
+    */
+    inline std::uint64_t vectorMapMemoryQuota() const noexcept
+    { return m_vectorMapMemoryQuota; }
+
+    /**
+      \returns the size in bytes above which the payloads of a value vector
+               are spilled to disk or 0 if never.
+    */
+    inline std::uint64_t vectorMapSpillThreshold() const noexcept
+    { return m_vectorMapSpillThreshold; }
+
+    /** \returns the directory in which value vectors are spilled. */
+    inline std::string const & vectorMapSpillDirectory() const noexcept
+    { return m_vectorMapSpillDirectory; }
+
+    /**
+      \returns the directory of vector map snapshots or an empty string if
+               snapshots are disabled.
+    */
+    inline std::string const & vectorMapSnapshotDirectory() const noexcept
+    { return m_vectorMapSnapshotDirectory; }
+
 private: /* Fields: */
 
     DbModuleList m_dbModuleList;
     DataSourceList m_dataSourceList;
+    std::size_t m_asyncWorkers = 2u;
+    std::uint64_t m_vectorMapMemoryQuota = 0u;
+    std::uint64_t m_vectorMapSpillThreshold = 0u;
+    std::string m_vectorMapSpillDirectory = "/tmp";
+    std::string m_vectorMapSnapshotDirectory;
 
 }; /* class TdbConfiguration { */
 
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SHAREMIND_MOD_TABLEDB_TDBCURSORTABLE_H
+#define SHAREMIND_MOD_TABLEDB_TDBCURSORTABLE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+
+namespace sharemind {
+
+/** \brief A column read cursor opened in a database module. */
+struct __attribute__ ((visibility("internal"))) TdbCursor {
+    std::string dsName;
+    std::string tblName;
+    std::uint64_t dbCursorId;
+};
+
+/**
+  \brief Per-process table of open column read cursors.
+
+  Programs refer to cursors by handles allocated here, which map to the data
+  source and table the cursor was opened on and to the identifier given to the
+  cursor by the database module.
+*/
+class __attribute__ ((visibility("internal"))) TdbCursorTable {
+
+public: /* Methods: */
+
+    /** \returns the handle of the new cursor. */
+    std::uint64_t insert(TdbCursor cursor) {
+        auto const handle = m_nextHandle;
+        m_cursors.emplace(handle, std::move(cursor));
+        ++m_nextHandle;
+        return handle;
+    }
+
+    /** \returns a pointer to the cursor with the given handle or nullptr. */
+    TdbCursor * find(std::uint64_t const handle) noexcept {
+        auto const it(m_cursors.find(handle));
+        return (it != m_cursors.end()) ? &it->second : nullptr;
+    }
+
+    TdbCursor const * find(std::uint64_t const handle) const noexcept
+    { return const_cast<TdbCursorTable *>(this)->find(handle); }
+
+    bool erase(std::uint64_t const handle) noexcept
+    { return m_cursors.erase(handle); }
+
+private: /* Fields: */
+
+    std::uint64_t m_nextHandle = 1u;
+    std::unordered_map<std::uint64_t, TdbCursor> m_cursors;
+
+}; /* class TdbCursorTable { */
+
+} /* namespace sharemind { */
+
+#endif /* SHAREMIND_MOD_TABLEDB_TDBCURSORTABLE_H */
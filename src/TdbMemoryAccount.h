@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+
+#ifndef SHAREMIND_MOD_TABLEDB_TDBMEMORYACCOUNT_H
+#define SHAREMIND_MOD_TABLEDB_TDBMEMORYACCOUNT_H
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+
+
+namespace sharemind {
+
+/**
+  \brief The memory held by the vector maps of a process and its quota.
+
+  Vector maps charge their growth to the account of their process and release
+  their memory when they shrink or are destroyed. A quota of zero means that
+  the memory held is not limited.
+*/
+class __attribute__ ((visibility("internal"))) TdbMemoryAccount {
+
+public: /* Methods: */
+
+    explicit TdbMemoryAccount(std::uint64_t const quota) noexcept
+        : m_quota(quota)
+    {}
+
+    TdbMemoryAccount(TdbMemoryAccount const &) = delete;
+    TdbMemoryAccount & operator=(TdbMemoryAccount const &) = delete;
+
+    std::uint64_t used() const noexcept
+    { return m_used.load(std::memory_order_relaxed); }
+
+    std::uint64_t quota() const noexcept { return m_quota; }
+
+    /** \returns whether the given number of bytes more fit in the quota. */
+    bool allows(std::uint64_t const bytes) const noexcept {
+        if (!m_quota)
+            return true;
+        auto const u = used();
+        return u <= m_quota && bytes <= m_quota - u;
+    }
+
+    void charge(std::uint64_t const bytes) noexcept
+    { m_used.fetch_add(bytes, std::memory_order_relaxed); }
+
+    void release(std::uint64_t const bytes) noexcept {
+        assert(used() >= bytes);
+        m_used.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+private: /* Fields: */
+
+    std::uint64_t const m_quota;
+    std::atomic<std::uint64_t> m_used{0u};
+
+}; /* class TdbMemoryAccount { */
+
+} /* namespace sharemind { */
+
+#endif /* SHAREMIND_MOD_TABLEDB_TDBMEMORYACCOUNT_H */
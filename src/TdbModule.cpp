@@ -19,23 +19,81 @@
 
 #include "TdbModule.h"
 
+#include <cassert>
 #include <memory>
+#include <mutex>
+#include <new>
 #include <sharemind/libconfiguration/Configuration.h>
 #include <sstream>
 #include "DataSource.h"
 #include "TdbConfiguration.h"
+#include "TdbCursorTable.h"
+#include "TdbMemoryAccount.h"
+#include "TdbProcessContext.h"
 #include "TdbVectorMap.h"
 
 
 namespace sharemind {
 
+namespace {
+
+template <class T>
+void destroy(void * ptr) noexcept { delete static_cast<T *>(ptr); }
+
+/* The process context of the syscall running on this thread, if any: */
+thread_local struct {
+    const SharemindModuleApi0x1SyscallContext * ctx;
+    TdbProcessContext * process;
+} currentProcessContext{nullptr, nullptr};
+
+std::vector<std::string> concat(std::vector<std::string> const & a,
+                                std::vector<std::string> const & b)
+{
+    std::vector<std::string> r;
+    r.reserve(a.size() + b.size());
+    r.insert(r.end(), a.begin(), a.end());
+    r.insert(r.end(), b.begin(), b.end());
+    return r;
+}
+
+/**
+  \returns whether the constant references are the data source and table names
+           only, setting table to the latter.
+*/
+bool getTableName(const SharemindModuleApi0x1CReference * crefs,
+                  boost::string_view & table)
+{
+    if (!crefs || !crefs[0u].pData || !crefs[1u].pData || crefs[2u].pData)
+        return false;
+    auto const & ref = crefs[1u];
+    if (!ref.size || static_cast<char const *>(ref.pData)[ref.size - 1u])
+        return false;
+    table = boost::string_view(static_cast<char const *>(ref.pData),
+                               ref.size - 1u);
+    return true;
+}
+
+} // anonymous namespace
+
 TdbModule::TdbModule(const LogHard::Logger & logger,
                      SharemindConsensusFacility * consensusService,
                      const std::string & config,
-                     std::vector<std::string> requiredSyscallSignatures)
+                     std::vector<std::string> requiredSyscallSignatures,
+                     std::vector<std::string> optionalSyscallSignatures,
+                     std::vector<std::string> instrumentedSyscalls,
+                     std::vector<TdbTableCache::Use> tableCacheUses)
     : m_logger(logger, "[TdbModule]")
-    , m_dbModuleLoader(std::move(requiredSyscallSignatures), m_logger)
+    , m_statistics(m_logger,
+                   std::move(instrumentedSyscalls),
+                   concat(requiredSyscallSignatures,
+                          optionalSyscallSignatures))
+    , m_dbModuleLoader(std::move(requiredSyscallSignatures),
+                       std::move(optionalSyscallSignatures),
+                       m_logger)
+    , m_tableCacheUses(std::move(tableCacheUses))
 {
+    assert(m_tableCacheUses.size() == m_dbModuleLoader.numSignatures());
+
     // Load module configuration
     std::unique_ptr<TdbConfiguration> configuration;
     try {
@@ -45,6 +103,17 @@ TdbModule::TdbModule(const LogHard::Logger & logger,
                     ConfigurationException("Failed to parse configuration!"));
     }
 
+    if (!configuration->asyncWorkers())
+        throw ConfigurationException("The number of asynchronous workers "
+                                     "must be positive!");
+    m_asyncExecutor =
+            std::make_unique<TdbAsyncExecutor>(configuration->asyncWorkers());
+    m_mapUtil.setMemoryQuota(configuration->vectorMapMemoryQuota());
+    m_mapUtil.setSpillPolicy(configuration->vectorMapSpillDirectory(),
+                             configuration->vectorMapSpillThreshold());
+    m_vectorMapSnapshotDirectory =
+            configuration->vectorMapSnapshotDirectory();
+
     // Set database module facilities
     #define SET_FACILITY(n,w) \
         try { \
@@ -57,6 +126,7 @@ TdbModule::TdbModule(const LogHard::Logger & logger,
     SET_FACILITY("Logger", &const_cast<LogHard::Logger &>(m_logger));
     SET_FACILITY("DataSourceManager", m_dataSourceManager.getWrapper());
     SET_FACILITY("TdbVectorMapUtil", m_mapUtil.getWrapper());
+    SET_FACILITY("TdbStatistics", m_statistics.getWrapper());
     if (consensusService) {
         SET_FACILITY("ConsensusService", consensusService);
     }
@@ -97,39 +167,80 @@ TdbModule::TdbModule(const LogHard::Logger & logger,
             throw ConfigurationException("Configuration contained duplicate "
                                          "configuration entries!");
         }
+
+        // Resolve the syscalls of the data source beforehand:
+        DataSource * const src =
+                m_dataSourceManager.getDataSource(cfgDs.name);
+        assert(src);
+        src->setSyscallTable(m_dbModuleLoader.syscallTable(cfgDs.dbModule));
+        src->setCapabilities(m_dbModuleLoader.capabilities(cfgDs.dbModule));
+        src->setStatistics(m_statistics.addDataSource(cfgDs.name));
+        if (cfgDs.tableCache)
+            src->enableTableCache();
     }
 
 }
 
-TdbModule::~TdbModule() { }
+TdbModule::~TdbModule() { m_statistics.dump(); }
+
+TdbModule::ProcessContextScope::ProcessContextScope(
+        const SharemindModuleApi0x1SyscallContext * ctx,
+        TdbProcessContext * process) noexcept
+    : m_oldCtx(currentProcessContext.ctx)
+    , m_oldProcess(currentProcessContext.process)
+{
+    currentProcessContext.ctx = ctx;
+    currentProcessContext.process = process;
+}
+
+TdbModule::ProcessContextScope::~ProcessContextScope() noexcept {
+    currentProcessContext.ctx = m_oldCtx;
+    currentProcessContext.process = m_oldProcess;
+}
 
 bool TdbModule::getErrorCode(
         const SharemindModuleApi0x1SyscallContext * ctx,
-        const std::string & dsName,
-        SharemindTdbError & code) const noexcept
-{
-    return dataStoreAction(
-                ctx,
-                "mod_tabledb/errors",
-                [&dsName, &code](SharemindDataStore * const errors) noexcept {
-                    SharemindTdbError const * const e =
-                            static_cast<SharemindTdbError *>(
-                                errors->get(errors, dsName.c_str()));
-                    code = e ? *e : SHAREMIND_TDB_OK;
-                    return true;
-                },
-                false);
-}
-
-SharemindModuleApi0x1Error TdbModule::doSyscall(const std::string & dsName,
-                                                const std::string & signature,
+        const char * dsName,
+        SharemindTdbError & code) noexcept
+{
+    TdbProcessContext * const process = processContext(ctx);
+    if (!process)
+        return false;
+    SharemindDataStore * const errors = process->errors();
+    if (!errors) {
+        m_logger.error() << "Failed to get process data store: "
+                            "mod_tabledb/errors!";
+        return false;
+    }
+    SharemindTdbError const * const e =
+            static_cast<SharemindTdbError *>(
+                errors->get(errors, dsName));
+    code = e ? *e : SHAREMIND_TDB_OK;
+    return true;
+}
+
+bool TdbModule::getCapabilities(const boost::string_view dsName,
+                                std::uint64_t & capabilities) const
+{
+    DataSource const * const src = m_dataSourceManager.getDataSource(dsName);
+    if (!src)
+        return false;
+    capabilities = src->capabilities();
+    return true;
+}
+
+SharemindModuleApi0x1Error TdbModule::doSyscall(const boost::string_view dsName,
+                                                std::size_t syscall,
+                                                TdbStatistics::Clock::duration aclTime,
                                                 SharemindCodeBlock * args,
                                                 size_t num_args,
                                                 const SharemindModuleApi0x1Reference * refs,
                                                 const SharemindModuleApi0x1CReference * crefs,
                                                 SharemindCodeBlock * returnValue,
-                                                SharemindModuleApi0x1SyscallContext * c) const
+                                                SharemindModuleApi0x1SyscallContext * c)
 {
+    auto const dispatchStart(TdbStatistics::Clock::now());
+
     // Get the data source object
     DataSource * const src = m_dataSourceManager.getDataSource(dsName);
     if (!src) {
@@ -138,60 +249,352 @@ SharemindModuleApi0x1Error TdbModule::doSyscall(const std::string & dsName,
     }
 
     // Get the system call object
-    const SharemindSyscallWrapper sw =
-            m_dbModuleLoader.getSyscall(src->module(), signature);
+    const SharemindSyscallWrapper sw = src->syscall(syscall);
+    auto & statistics = src->statistics(syscall);
     if (!sw.callable) {
+        auto const now(TdbStatistics::Clock::now());
+        statistics.record(aclTime,
+                          now - dispatchStart,
+                          TdbStatistics::Clock::duration::zero(),
+                          true);
         m_logger.error()
             << "Data source \"" << dsName << "\" database module \""
             << src->module() << "\" has no system call with signature \""
-            << signature << "\".";
+            << m_dbModuleLoader.signature(syscall) << "\".";
         return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
     }
 
+    // Try the table cache
+    TdbTableCache * const cache = src->tableCache();
+    auto const & cacheUse = m_tableCacheUses[syscall];
+    boost::string_view tblName;
+    bool const haveTable = cache && getTableName(crefs, tblName);
+    TdbTableCache::Entry cacheEntry = TdbTableCache::NoEntry;
+    std::uint64_t cacheGeneration = 0u;
+    if (haveTable
+        && cacheUse.entry != TdbTableCache::NoEntry
+        && !num_args
+        && (!refs || !refs[0u].pData)
+        && returnValue)
+    {
+        TdbTableCache::Result result;
+        if (cache->find(tblName, cacheUse.entry, result, cacheGeneration)) {
+            if (result.vectors) {
+                uint64_t vmapId;
+                if (!newVectorMap(c, vmapId))
+                    return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+                try {
+                    TdbVectorMap * const map = getVectorMap(c, vmapId);
+                    assert(map);
+                    TdbTableCache::restoreVectors(*result.vectors, *map);
+                } catch (...) {
+                    deleteVectorMap(c, vmapId);
+                    throw;
+                }
+                returnValue->uint64[0u] = vmapId;
+            } else {
+                *returnValue = result.value;
+            }
+            statistics.recordCacheHit(aclTime,
+                                      TdbStatistics::Clock::now()
+                                      - dispatchStart);
+            return SHAREMIND_MODULE_API_0x1_OK;
+        }
+        statistics.recordCacheMiss();
+        cacheEntry = cacheUse.entry;
+    }
+
     // Do the system call
     SharemindSyscallContext sc = *c;
     sc.moduleHandle = sw.internal;
 
-    return (*(sw.callable))(args, num_args, refs, crefs, returnValue, &sc);
+    auto const dbModuleStart(TdbStatistics::Clock::now());
+    auto const r =
+            (*(sw.callable))(args, num_args, refs, crefs, returnValue, &sc);
+    statistics.record(aclTime,
+                      dbModuleStart - dispatchStart,
+                      TdbStatistics::Clock::now() - dbModuleStart,
+                      r != SHAREMIND_MODULE_API_0x1_OK);
+
+    // Update the table cache
+    if (haveTable) {
+        // Even failed calls may have modified the table:
+        if (cacheUse.invalidates)
+            cache->invalidate(tblName, cacheUse.invalidates);
+
+        if (cacheEntry != TdbTableCache::NoEntry
+            && r == SHAREMIND_MODULE_API_0x1_OK)
+        {
+            // Caching is best effort, the call has already succeeded:
+            try {
+                TdbTableCache::Result result;
+                if (TdbTableCache::isVectorMapEntry(cacheEntry)) {
+                    TdbVectorMap const * const map =
+                            getVectorMap(c, returnValue->uint64[0u]);
+                    if (map)
+                        result.vectors = TdbTableCache::copyVectors(*map);
+                    if (!result.vectors)
+                        return r;
+                } else {
+                    result.value = *returnValue;
+                }
+                cache->insert(tblName,
+                              cacheEntry,
+                              std::move(result),
+                              cacheGeneration);
+            } catch (...) {}
+        }
+    }
+    return r;
+}
+
+SharemindModuleApi0x1Error TdbModule::doSyscallAsync(const boost::string_view dsName,
+                                                     std::size_t syscall,
+                                                     TdbStatistics::Clock::duration aclTime,
+                                                     SharemindCodeBlock * args,
+                                                     size_t num_args,
+                                                     const SharemindModuleApi0x1CReference * crefs,
+                                                     SharemindModuleApi0x1SyscallContext * c,
+                                                     uint64_t & handle)
+{
+    if (!m_dataSourceManager.getDataSource(dsName)) {
+        m_logger.error() << "Data source \"" << dsName << "\" is not defined.";
+        return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+    }
+
+    TdbProcessContext * const context = processContext(c);
+    if (!context)
+        return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+    auto const process(context->shared_from_this());
+
+    // The memory of the program may change before the call is run:
+    std::string const queue(dsName.to_string());
+    std::vector<SharemindCodeBlock> argsCopy(args, args + num_args);
+    std::vector<std::string> crefsCopy;
+    for (auto * cref = crefs; cref && cref->pData; ++cref)
+        crefsCopy.emplace_back(static_cast<char const *>(cref->pData),
+                               cref->size);
+
+    auto call(std::make_shared<TdbAsyncCall>());
+    handle = process->async().insert(call);
+    try {
+        m_asyncExecutor->submit(
+            queue,
+            [this, process, call, dsName = queue, syscall, aclTime, ctx = *c,
+             args = std::move(argsCopy),
+             crefs = std::move(crefsCopy)]() mutable noexcept
+            {
+                SharemindCodeBlock returnValue;
+                returnValue.uint64[0u] = 0u;
+                SharemindModuleApi0x1Error r;
+                try {
+                    std::vector<SharemindModuleApi0x1CReference> refs;
+                    refs.reserve(crefs.size() + 1u);
+                    for (auto const & cref : crefs)
+                        refs.push_back({cref.data(), cref.size()});
+                    refs.push_back({nullptr, 0u});
+
+                    std::lock_guard<std::mutex> const guard(
+                                process->async().mutex());
+                    ProcessContextScope const scope(&ctx, process.get());
+                    r = doSyscall(dsName,
+                                  syscall,
+                                  aclTime,
+                                  args.data(),
+                                  args.size(),
+                                  nullptr,
+                                  refs.data(),
+                                  &returnValue,
+                                  &ctx);
+                } catch (const std::bad_alloc &) {
+                    r = SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+                } catch (...) {
+                    r = SHAREMIND_MODULE_API_0x1_MODULE_ERROR;
+                }
+                call->complete(r, returnValue);
+            });
+    } catch (...) {
+        process->async().erase(handle);
+        throw;
+    }
+    return SHAREMIND_MODULE_API_0x1_OK;
+}
+
+void TdbModule::invalidateTableCache(const boost::string_view dsName,
+                                     std::size_t const syscall,
+                                     const boost::string_view tblName)
+{
+    DataSource * const src = m_dataSourceManager.getDataSource(dsName);
+    if (!src || !src->tableCache())
+        return;
+    if (auto const entries = m_tableCacheUses[syscall].invalidates)
+        src->tableCache()->invalidate(tblName, entries);
+}
+
+TdbProcessContext * TdbModule::processContext(
+        const SharemindModuleApi0x1SyscallContext * ctx) noexcept
+{
+    if (currentProcessContext.ctx == ctx)
+        return currentProcessContext.process;
+
+    // The data store factory identifies the process:
+    SharemindDataStoreFactory * const factory =
+            static_cast<SharemindDataStoreFactory *>(
+                ctx->processFacility(ctx, "DataStoreFactory"));
+    if (!factory) {
+        m_logger.error() << "Failed to get process data store factory!";
+        return nullptr;
+    }
+    {
+        std::lock_guard<std::mutex> const guard(m_processContextsMutex);
+        auto const it(m_processContexts.find(factory));
+        if (it != m_processContexts.end())
+            return it->second.get();
+    }
+
+    /*
+      This is the first call of the process, hence no asynchronous calls of
+      the process are running and the process data stores are safe to use. The
+      registration is kept in a process data store, which waits for the
+      asynchronous calls of the process and forgets the process when the data
+      stores are destroyed. The workers also use the vector map and error data
+      stores of the process, hence these have to outlive the data store of the
+      registration. The registration is stored only after the process context
+      has requested them, so a process destroying its data stores in the
+      reverse order of their creation destroys the registration first.
+    */
+    struct Registration {
+        Registration(TdbModule & m,
+                     void const * const k,
+                     std::shared_ptr<TdbProcessContext> p)
+            : module(m)
+            , key(k)
+            , process(std::move(p))
+        {
+            std::lock_guard<std::mutex> const guard(
+                        module.m_processContextsMutex);
+            module.m_processContexts.emplace(key, process);
+        }
+
+        ~Registration() noexcept {
+            process->async().waitAll();
+            std::lock_guard<std::mutex> const guard(
+                        module.m_processContextsMutex);
+            module.m_processContexts.erase(key);
+        }
+
+        TdbModule & module;
+        void const * const key;
+        std::shared_ptr<TdbProcessContext> const process;
+    };
+
+    try {
+        std::unique_ptr<Registration> registration(
+                    new Registration(
+                        *this,
+                        factory,
+                        std::make_shared<TdbProcessContext>(*ctx, *factory)));
+        SharemindDataStore * const store =
+                factory->get_datastore(factory, "mod_tabledb/process");
+        if (!store) {
+            m_logger.error() << "Failed to get process data store: "
+                                "mod_tabledb/process!";
+            return nullptr;
+        }
+        if (!store->set(store,
+                        "object",
+                        registration.get(),
+                        &destroy<Registration>))
+            return nullptr;
+        return registration.release()->process.get();
+    } catch (...) {
+        m_logger.printCurrentException();
+        return nullptr;
+    }
 }
 
 bool TdbModule::newVectorMap(const SharemindModuleApi0x1SyscallContext * ctx,
                              uint64_t & stmtId)
 {
-    return dataStoreAction(ctx,
-                           "mod_tabledb/vector_maps",
-                           [this, &stmtId](SharemindDataStore * const maps) {
-                               if (TdbVectorMap * const map =
-                                       m_mapUtil.newVectorMap(maps))
-                               {
-                                   stmtId = map->getId();
-                                   return true;
-                               }
-                               return false;
-                           },
-                           false);
+    TdbProcessContext * const process = processContext(ctx);
+    if (!process || !vectorMapStore(*process))
+        return false;
+    if (TdbVectorMap * const map =
+            m_mapUtil.newVectorMap(process->vectorMaps()))
+    {
+        stmtId = map->getId();
+        return true;
+    }
+    return false;
 }
 
 bool TdbModule::deleteVectorMap(const SharemindModuleApi0x1SyscallContext * ctx,
                                 const uint64_t stmtId) noexcept
 {
-    return dataStoreAction(
-                ctx,
-                "mod_tabledb/vector_maps",
-                [this, stmtId](SharemindDataStore * const maps) noexcept
-                { return m_mapUtil.deleteVectorMap(maps, stmtId); },
-                false);
+    TdbProcessContext * const process = processContext(ctx);
+    if (!process || !vectorMapStore(*process))
+        return false;
+    return m_mapUtil.deleteVectorMap(process->vectorMaps(), stmtId);
 }
 
 TdbVectorMap * TdbModule::getVectorMap(const SharemindModuleApi0x1SyscallContext * ctx,
-                                       const uint64_t stmtId) const noexcept
-{
-    return dataStoreAction(
-                ctx,
-                "mod_tabledb/vector_maps",
-                [this, stmtId](SharemindDataStore * const maps) noexcept
-                { return m_mapUtil.getVectorMap(maps, stmtId); },
-                nullptr);
+                                       const uint64_t stmtId) noexcept
+{
+    TdbProcessContext * const process = processContext(ctx);
+    if (!process || !vectorMapStore(*process))
+        return nullptr;
+    return m_mapUtil.getVectorMap(process->vectorMaps(), stmtId);
+}
+
+bool TdbModule::vectorMapMemoryUsage(
+        const SharemindModuleApi0x1SyscallContext * ctx,
+        uint64_t & bytes) noexcept
+{
+    TdbProcessContext * const process = processContext(ctx);
+    if (!process || !vectorMapStore(*process))
+        return false;
+    auto const account(m_mapUtil.memoryAccount(process->vectorMaps()));
+    bytes = account ? account->used() : 0u;
+    return true;
+}
+
+bool TdbModule::vectorMapSnapshotPath(const boost::string_view name,
+                                      std::string & path) const
+{
+    if (m_vectorMapSnapshotDirectory.empty()) {
+        m_logger.error() << "Vector map snapshots are disabled.";
+        return false;
+    }
+    if (name.empty()
+        || name == "."
+        || name == ".."
+        || name.find_first_of(boost::string_view("/\0", 2u))
+           != boost::string_view::npos)
+    {
+        m_logger.error() << "Invalid vector map snapshot name.";
+        return false;
+    }
+    path = m_vectorMapSnapshotDirectory;
+    path += '/';
+    path.append(name.data(), name.size());
+    return true;
+}
+
+TdbCursorTable * TdbModule::cursorTable(
+        const SharemindModuleApi0x1SyscallContext * ctx) noexcept
+{
+    TdbProcessContext * const process = processContext(ctx);
+    return process ? &process->cursorTable() : nullptr;
+}
+
+bool TdbModule::vectorMapStore(TdbProcessContext const & process) const
+        noexcept
+{
+    if (process.vectorMaps())
+        return true;
+    m_logger.error() << "Failed to get process data store: "
+                        "mod_tabledb/vector_maps!";
+    return false;
 }
 
 } /* namespace sharemind { */
@@ -20,9 +20,13 @@
 #ifndef SHAREMIND_MOD_TDB_TDBMODULE_H
 #define SHAREMIND_MOD_TDB_TDBMODULE_H
 
+#include <boost/utility/string_view.hpp>
+#include <cstdint>
 #include <exception>
 #include <LogHard/Logger.h>
-#include <sharemind/datastoreapi.h>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <sharemind/libconsensusservice.h>
 #include <sharemind/module-apis/api_0x1.h>
 #include <string>
@@ -30,12 +34,17 @@
 #include <vector>
 #include "DataSourceManager.h"
 #include "ModuleLoader.h"
+#include "TdbAsyncExecutor.h"
+#include "TdbStatistics.h"
+#include "TdbTableCache.h"
 #include "TdbVectorMapUtil.h"
 #include "tdberror.h"
 
 
 namespace sharemind  {
 
+class TdbCursorTable;
+class TdbProcessContext;
 class TdbVectorMap;
 
 class __attribute__ ((visibility("internal"))) TdbModule {
@@ -68,75 +77,157 @@ public: /* Types: */
 
     };
 
+    /**
+      \brief Makes processContext() return the given context for the given
+             syscall context on this thread while in scope.
+    */
+    class ProcessContextScope {
+
+    public: /* Methods: */
+
+        ProcessContextScope(const SharemindModuleApi0x1SyscallContext * ctx,
+                            TdbProcessContext * process) noexcept;
+        ~ProcessContextScope() noexcept;
+
+        ProcessContextScope(ProcessContextScope const &) = delete;
+        ProcessContextScope & operator=(ProcessContextScope const &) = delete;
+
+    private: /* Fields: */
+
+        const SharemindModuleApi0x1SyscallContext * const m_oldCtx;
+        TdbProcessContext * const m_oldProcess;
+
+    };
+
 public: /* Methods: */
 
     TdbModule(const LogHard::Logger & logger,
               SharemindConsensusFacility * consensusService,
               const std::string & config,
-              std::vector<std::string> requiredSyscallSignatures);
+              std::vector<std::string> requiredSyscallSignatures,
+              std::vector<std::string> optionalSyscallSignatures,
+              std::vector<std::string> instrumentedSyscalls,
+              std::vector<TdbTableCache::Use> tableCacheUses);
     ~TdbModule();
 
     bool getErrorCode(const SharemindModuleApi0x1SyscallContext * ctx,
-            const std::string & dsName,
-            SharemindTdbError & code) const noexcept;
-
-    SharemindModuleApi0x1Error doSyscall(const std::string & dsName,
-                                         const std::string & signature,
+            const char * dsName,
+            SharemindTdbError & code) noexcept;
+
+    /**
+      \brief Gets the bitmap of the optional syscalls provided by the database
+             module of a data source.
+      \returns false if the data source is not defined.
+    */
+    bool getCapabilities(const boost::string_view dsName,
+                         std::uint64_t & capabilities) const;
+
+    /**
+      \brief Forwards a syscall to the database module of a data source.
+      \param[in] syscall index of the syscall signature in the list of
+                         required syscall signatures followed by the optional
+                         syscall signatures given to the constructor.
+      \param[in] aclTime time spent on checking access to the data source.
+
+      If the table cache of the data source is enabled, results of syscalls
+      taking only the data source and table names are answered from and stored
+      in the cache as given by the table cache uses given to the constructor.
+    */
+    SharemindModuleApi0x1Error doSyscall(const boost::string_view dsName,
+                                         std::size_t syscall,
+                                         TdbStatistics::Clock::duration aclTime,
                                          SharemindCodeBlock * args,
                                          size_t num_args,
                                          const SharemindModuleApi0x1Reference * refs,
                                          const SharemindModuleApi0x1CReference * crefs,
                                          SharemindCodeBlock * returnValue,
-                                         SharemindModuleApi0x1SyscallContext * c) const;
+                                         SharemindModuleApi0x1SyscallContext * c);
+
+    /**
+      \brief Forwards a syscall to the database module of a data source on a
+             worker thread.
+
+      The arguments and constant references are copied, references are not
+      supported. Calls on the same data source run in the order they were
+      made. Vector maps given to the call must not be used by the program
+      until the call has completed.
+
+      \param[out] handle set to the handle of the call in the asynchronous
+                         calls of the process context.
+    */
+    SharemindModuleApi0x1Error doSyscallAsync(const boost::string_view dsName,
+                                              std::size_t syscall,
+                                              TdbStatistics::Clock::duration aclTime,
+                                              SharemindCodeBlock * args,
+                                              size_t num_args,
+                                              const SharemindModuleApi0x1CReference * crefs,
+                                              SharemindModuleApi0x1SyscallContext * c,
+                                              uint64_t & handle);
+
+    /**
+      \returns the context of the process, creating it on the first call of
+               the process, or nullptr on failure.
+    */
+    TdbProcessContext * processContext(
+            const SharemindModuleApi0x1SyscallContext * ctx) noexcept;
+
+    /**
+      \brief Drops the table cache entries of a table invalidated by a syscall
+             which was not made through doSyscall().
+    */
+    void invalidateTableCache(const boost::string_view dsName,
+                              std::size_t syscall,
+                              const boost::string_view tblName);
 
     bool newVectorMap(const SharemindModuleApi0x1SyscallContext * ctx,
                       uint64_t & vmapId);
     bool deleteVectorMap(const SharemindModuleApi0x1SyscallContext * ctx,
                          const uint64_t vmapId) noexcept;
     TdbVectorMap * getVectorMap(const SharemindModuleApi0x1SyscallContext * ctx,
-                                const uint64_t vmapId) const noexcept;
+                                const uint64_t vmapId) noexcept;
 
-    inline const LogHard::Logger & logger() const noexcept { return m_logger; }
+    /** \brief Gets the memory held by the vector maps of the process. */
+    bool vectorMapMemoryUsage(const SharemindModuleApi0x1SyscallContext * ctx,
+                              uint64_t & bytes) noexcept;
 
-private: /* Methods: */
+    /**
+      \brief Gets the path of the vector map snapshot with the given name.
+      \returns false if snapshots are disabled or the name is not a plain file
+               name.
+    */
+    bool vectorMapSnapshotPath(const boost::string_view name,
+                               std::string & path) const;
 
-    template <typename F, typename R, typename ... Args>
-    inline auto dataStoreAction(
-                SharemindModuleApi0x1SyscallContext const * const ctx,
-                char const * const dsName,
-                F action,
-                R errorValue,
-                Args && ... args) const
-            noexcept(noexcept(action(std::declval<SharemindDataStore *>(),
-                                     std::forward<Args>(args)...)))
-            -> decltype(action(std::declval<SharemindDataStore *>(),
-                               std::forward<Args>(args)...))
-    {
-        // Get factory:
-        SharemindDataStoreFactory * const factory =
-                static_cast<SharemindDataStoreFactory *>(
-                    ctx->processFacility(ctx, "DataStoreFactory"));
-        if (!factory) {
-            m_logger.error() << "Failed to get process data store factory!";
-            return errorValue;
-        }
+    /** \returns the column read cursors of the process, if available. */
+    TdbCursorTable * cursorTable(
+            const SharemindModuleApi0x1SyscallContext * ctx) noexcept;
 
-        // Get store
-        if (SharemindDataStore * const ds =
-                factory->get_datastore(factory, dsName))
-            return action(ds, std::forward<Args>(args)...);
+    inline const LogHard::Logger & logger() const noexcept { return m_logger; }
 
-        m_logger.error() << "Failed to get process data store: " << dsName
-                         << '!';
-        return errorValue;
-    }
+    inline TdbStatistics & statistics() noexcept { return m_statistics; }
+
+private: /* Methods: */
+
+    /** \returns whether the vector map data store of the process exists. */
+    bool vectorMapStore(TdbProcessContext const & process) const noexcept;
 
 private: /* Fields: */
 
     const LogHard::Logger m_logger;
+    TdbStatistics m_statistics;
     ModuleLoader m_dbModuleLoader;
     DataSourceManager m_dataSourceManager;
     TdbVectorMapUtil m_mapUtil;
+    std::string m_vectorMapSnapshotDirectory;
+    std::vector<TdbTableCache::Use> const m_tableCacheUses;
+
+    /* The contexts of processes by their data store factories: */
+    mutable std::mutex m_processContextsMutex;
+    std::map<void const *, std::shared_ptr<TdbProcessContext> >
+            m_processContexts;
+
+    /* Declared last to stop the workers before anything they use: */
+    std::unique_ptr<TdbAsyncExecutor> m_asyncExecutor;
 
 }; /* class TdbModule { */
 
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SHAREMIND_MOD_TABLEDB_TDBPROCESSCONTEXT_H
+#define SHAREMIND_MOD_TABLEDB_TDBPROCESSCONTEXT_H
+
+#include <memory>
+#include <sharemind/AccessControlProcessFacility.h>
+#include <sharemind/datastoreapi.h>
+#include <sharemind/libprocessfacility.h>
+#include <sharemind/module-apis/api_0x1.h>
+#include <string>
+#include "TdbAclCache.h"
+#include "TdbAsyncProcess.h"
+#include "TdbCursorTable.h"
+
+
+namespace sharemind {
+
+/**
+  \brief The state of this module for a process.
+
+  Resolves the process facilities, the program name and the process data
+  stores of this module once, when the process first calls this module. The
+  facilities and data stores are null if the process does not provide them.
+*/
+class __attribute__ ((visibility("internal"))) TdbProcessContext
+    : public std::enable_shared_from_this<TdbProcessContext>
+{
+
+public: /* Methods: */
+
+    TdbProcessContext(SharemindModuleApi0x1SyscallContext const & c,
+                      SharemindDataStoreFactory & factory)
+        : m_aclFacility(
+              static_cast<AccessControlProcessFacility const *>(
+                  c.processFacility(&c, "AccessControlProcessFacility")))
+        , m_processFacility(
+              static_cast<SharemindProcessFacility const *>(
+                  c.processFacility(&c, "ProcessFacility")))
+        , m_programName(m_processFacility
+                        ? m_processFacility->programName(m_processFacility)
+                        : "")
+        , m_vectorMaps(factory.get_datastore(&factory,
+                                             "mod_tabledb/vector_maps"))
+        , m_errors(factory.get_datastore(&factory, "mod_tabledb/errors"))
+    {}
+
+    AccessControlProcessFacility const * aclFacility() const noexcept
+    { return m_aclFacility; }
+
+    SharemindProcessFacility const * processFacility() const noexcept
+    { return m_processFacility; }
+
+    std::string const & programName() const noexcept
+    { return m_programName; }
+
+    SharemindDataStore * vectorMaps() const noexcept { return m_vectorMaps; }
+    SharemindDataStore * errors() const noexcept { return m_errors; }
+
+    TdbAclCache & aclCache() noexcept { return m_aclCache; }
+    TdbCursorTable & cursorTable() noexcept { return m_cursorTable; }
+    TdbAsyncProcess & async() noexcept { return m_async; }
+
+private: /* Fields: */
+
+    AccessControlProcessFacility const * const m_aclFacility;
+    SharemindProcessFacility const * const m_processFacility;
+    std::string const m_programName;
+    SharemindDataStore * const m_vectorMaps;
+    SharemindDataStore * const m_errors;
+    TdbAclCache m_aclCache;
+    TdbCursorTable m_cursorTable;
+    TdbAsyncProcess m_async;
+
+}; /* class TdbProcessContext { */
+
+} /* namespace sharemind { */
+
+#endif /* SHAREMIND_MOD_TABLEDB_TDBPROCESSCONTEXT_H */
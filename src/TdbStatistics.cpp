@@ -0,0 +1,215 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "TdbStatistics.h"
+
+#include <cassert>
+#include <ostream>
+#include <sstream>
+#include <utility>
+
+
+namespace {
+
+using namespace sharemind;
+
+void printHistogram(std::ostream & stream,
+                    char const * const name,
+                    TdbLatencyHistogram const & h)
+{
+    stream << name << " mean " << h.mean() << " ns, p50 " << h.percentile(50u)
+           << " ns, p99 " << h.percentile(99u) << " ns, max " << h.max()
+           << " ns";
+}
+
+extern "C" {
+
+void SharemindTdbStatistics_dump(SharemindTdbStatistics * stats) {
+    assert(stats);
+    TdbStatistics::fromWrapper(*stats).dump();
+}
+
+void SharemindTdbStatistics_reset(SharemindTdbStatistics * stats) {
+    assert(stats);
+    TdbStatistics::fromWrapper(*stats).reset();
+}
+
+uint64_t SharemindTdbStatistics_call_count(SharemindTdbStatistics * stats,
+                                           const char * syscall)
+{
+    assert(stats);
+    assert(syscall);
+    try {
+        return TdbStatistics::fromWrapper(*stats).callCount(syscall);
+    } catch (...) {
+        return 0u;
+    }
+}
+
+} /* extern "C" { */
+
+} // anonymous namespace
+
+namespace sharemind {
+
+constexpr unsigned TdbLatencyHistogram::subBucketBits;
+constexpr std::size_t TdbLatencyHistogram::subBuckets;
+constexpr std::size_t TdbLatencyHistogram::numBuckets;
+
+std::uint64_t TdbLatencyHistogram::percentile(unsigned const percent)
+        const noexcept
+{
+    assert(percent <= 100u);
+    auto const n = count();
+    if (!n)
+        return 0u;
+    auto rank = (n * percent + 99u) / 100u;
+    if (!rank)
+        rank = 1u;
+    std::uint64_t seen = 0u;
+    for (std::size_t i = 0u; i < numBuckets; ++i) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+            return lowerBound(i);
+    }
+    // Concurrent updates may have changed the count while scanning:
+    return max();
+}
+
+void TdbLatencyHistogram::reset() noexcept {
+    for (auto & bucket : m_buckets)
+        bucket.store(0u, std::memory_order_relaxed);
+    m_count.store(0u, std::memory_order_relaxed);
+    m_sum.store(0u, std::memory_order_relaxed);
+    m_max.store(0u, std::memory_order_relaxed);
+}
+
+std::size_t TdbLatencyHistogram::bucketOf(std::uint64_t const value) noexcept {
+    if (value < subBuckets)
+        return static_cast<std::size_t>(value);
+    unsigned const exponent =
+            63u - static_cast<unsigned>(__builtin_clzll(value));
+    auto const sub = (value >> (exponent - subBucketBits)) & (subBuckets - 1u);
+    return ((exponent - subBucketBits + 1u) << subBucketBits)
+           | static_cast<std::size_t>(sub);
+}
+
+std::uint64_t TdbLatencyHistogram::lowerBound(std::size_t const bucket)
+        noexcept
+{
+    assert(bucket < numBuckets);
+    if (bucket < subBuckets)
+        return bucket;
+    unsigned const exponent =
+            static_cast<unsigned>(bucket >> subBucketBits) + subBucketBits - 1u;
+    std::uint64_t const sub = bucket & (subBuckets - 1u);
+    return (subBuckets | sub) << (exponent - subBucketBits);
+}
+
+TdbStatistics::TdbStatistics(LogHard::Logger const & logger,
+                             std::vector<std::string> syscalls,
+                             std::vector<std::string> dbSyscalls)
+    : ::SharemindTdbStatistics{&SharemindTdbStatistics_dump,
+                               &SharemindTdbStatistics_reset,
+                               &SharemindTdbStatistics_call_count}
+    , m_logger(logger, "[Statistics]")
+    , m_syscallNames(std::move(syscalls))
+    , m_dbSyscallNames(std::move(dbSyscalls))
+    , m_syscalls(new TdbSyscallStatistics[m_syscallNames.size()])
+{}
+
+TdbDataSourceSyscallStatistics * TdbStatistics::addDataSource(
+        std::string const & name)
+{
+    auto & stats = m_dataSources[name];
+    if (!stats)
+        stats.reset(
+                new TdbDataSourceSyscallStatistics[m_dbSyscallNames.size()]);
+    return stats.get();
+}
+
+void TdbStatistics::dump() const noexcept {
+    try {
+        for (std::size_t i = 0u; i < m_syscallNames.size(); ++i) {
+            auto const & s = m_syscalls[i];
+            auto const calls = s.latency.count();
+            if (!calls)
+                continue;
+            std::ostringstream oss;
+            oss << m_syscallNames[i] << ": " << calls << " calls, "
+                << s.errors.load(std::memory_order_relaxed) << " errors,";
+            printHistogram(oss, " latency", s.latency);
+            m_logger.info() << oss.str();
+        }
+
+        for (auto const & dsStats : m_dataSources) {
+            for (std::size_t i = 0u; i < m_dbSyscallNames.size(); ++i) {
+                auto const & s = dsStats.second[i];
+                auto const calls = s.dbModule.count();
+                auto const hits = s.cacheHits.load(std::memory_order_relaxed);
+                if (!calls && !hits)
+                    continue;
+                std::ostringstream oss;
+                oss << "Data source \"" << dsStats.first << "\" "
+                    << m_dbSyscallNames[i] << ": " << calls << " calls, "
+                    << s.errors.load(std::memory_order_relaxed) << " errors,";
+                auto const misses =
+                        s.cacheMisses.load(std::memory_order_relaxed);
+                if (hits || misses)
+                    oss << ' ' << hits << " cache hits, " << misses
+                        << " cache misses,";
+                printHistogram(oss, " ACL check", s.acl);
+                printHistogram(oss, "; dispatch", s.dispatch);
+                printHistogram(oss, "; DB module", s.dbModule);
+                m_logger.info() << oss.str();
+            }
+        }
+    } catch (...) {
+        m_logger.printCurrentException();
+    }
+}
+
+void TdbStatistics::reset() noexcept {
+    for (std::size_t i = 0u; i < m_syscallNames.size(); ++i) {
+        m_syscalls[i].errors.store(0u, std::memory_order_relaxed);
+        m_syscalls[i].latency.reset();
+    }
+    for (auto const & dsStats : m_dataSources) {
+        for (std::size_t i = 0u; i < m_dbSyscallNames.size(); ++i) {
+            auto & s = dsStats.second[i];
+            s.errors.store(0u, std::memory_order_relaxed);
+            s.cacheHits.store(0u, std::memory_order_relaxed);
+            s.cacheMisses.store(0u, std::memory_order_relaxed);
+            s.acl.reset();
+            s.dispatch.reset();
+            s.dbModule.reset();
+        }
+    }
+}
+
+std::uint64_t TdbStatistics::callCount(std::string const & syscall)
+        const noexcept
+{
+    for (std::size_t i = 0u; i < m_syscallNames.size(); ++i)
+        if (m_syscallNames[i] == syscall)
+            return m_syscalls[i].latency.count();
+    return 0u;
+}
+
+} /* namespace sharemind { */
@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SHAREMIND_MOD_TABLEDB_TDBSTATISTICS_H
+#define SHAREMIND_MOD_TABLEDB_TDBSTATISTICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <LogHard/Logger.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "tdbstatisticsapi.h"
+
+
+namespace sharemind {
+
+/**
+  \brief Log-linear histogram of latencies in nanoseconds.
+
+  Every power of two range is split into a fixed number of linear sub-buckets,
+  bounding the relative error of reported percentiles to 1/4. All counters are
+  updated with relaxed atomic operations, hence recording is safe from several
+  threads at once.
+*/
+class __attribute__ ((visibility("internal"))) TdbLatencyHistogram {
+
+public: /* Constants: */
+
+    static constexpr unsigned subBucketBits = 2u;
+    static constexpr std::size_t subBuckets = 1u << subBucketBits;
+    static constexpr std::size_t numBuckets =
+            subBuckets + (64u - subBucketBits) * subBuckets;
+
+public: /* Methods: */
+
+    TdbLatencyHistogram() noexcept { reset(); }
+
+    TdbLatencyHistogram(TdbLatencyHistogram const &) = delete;
+    TdbLatencyHistogram & operator=(TdbLatencyHistogram const &) = delete;
+
+    void record(std::uint64_t const ns) noexcept {
+        m_buckets[bucketOf(ns)].fetch_add(1u, std::memory_order_relaxed);
+        m_count.fetch_add(1u, std::memory_order_relaxed);
+        m_sum.fetch_add(ns, std::memory_order_relaxed);
+        auto max = m_max.load(std::memory_order_relaxed);
+        while (ns > max
+               && !m_max.compare_exchange_weak(max,
+                                               ns,
+                                               std::memory_order_relaxed))
+        {}
+    }
+
+    std::uint64_t count() const noexcept
+    { return m_count.load(std::memory_order_relaxed); }
+
+    std::uint64_t sum() const noexcept
+    { return m_sum.load(std::memory_order_relaxed); }
+
+    std::uint64_t max() const noexcept
+    { return m_max.load(std::memory_order_relaxed); }
+
+    std::uint64_t mean() const noexcept {
+        auto const n = count();
+        return n ? sum() / n : 0u;
+    }
+
+    /**
+      \returns the lower bound of the bucket containing the given percentile
+               of the recorded values.
+    */
+    std::uint64_t percentile(unsigned percent) const noexcept;
+
+    void reset() noexcept;
+
+    static std::size_t bucketOf(std::uint64_t value) noexcept;
+
+    static std::uint64_t lowerBound(std::size_t bucket) noexcept;
+
+private: /* Fields: */
+
+    std::array<std::atomic<std::uint64_t>, numBuckets> m_buckets;
+    std::atomic<std::uint64_t> m_count;
+    std::atomic<std::uint64_t> m_sum;
+    std::atomic<std::uint64_t> m_max;
+
+}; /* class TdbLatencyHistogram { */
+
+/** \brief Statistics of a single syscall of this module. */
+struct __attribute__ ((visibility("internal"))) TdbSyscallStatistics {
+
+    template <typename Duration>
+    void record(Duration const duration, bool const failed) noexcept {
+        latency.record(toNanoseconds(duration));
+        if (failed)
+            errors.fetch_add(1u, std::memory_order_relaxed);
+    }
+
+    template <typename Duration>
+    static std::uint64_t toNanoseconds(Duration const duration) noexcept {
+        return static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        duration).count());
+    }
+
+    std::atomic<std::uint64_t> errors{0u};
+    TdbLatencyHistogram latency;
+
+}; /* struct TdbSyscallStatistics { */
+
+/**
+  \brief Statistics of a syscall forwarded to the database module of a single
+         data source, split into the phases of the forwarding.
+*/
+struct __attribute__ ((visibility("internal"))) TdbDataSourceSyscallStatistics {
+
+    template <typename Duration>
+    void record(Duration const aclTime,
+                Duration const dispatchTime,
+                Duration const dbModuleTime,
+                bool const failed) noexcept
+    {
+        acl.record(TdbSyscallStatistics::toNanoseconds(aclTime));
+        dispatch.record(TdbSyscallStatistics::toNanoseconds(dispatchTime));
+        dbModule.record(TdbSyscallStatistics::toNanoseconds(dbModuleTime));
+        if (failed)
+            errors.fetch_add(1u, std::memory_order_relaxed);
+    }
+
+    /** \brief Records a call answered from the table cache. */
+    template <typename Duration>
+    void recordCacheHit(Duration const aclTime, Duration const dispatchTime)
+            noexcept
+    {
+        acl.record(TdbSyscallStatistics::toNanoseconds(aclTime));
+        dispatch.record(TdbSyscallStatistics::toNanoseconds(dispatchTime));
+        cacheHits.fetch_add(1u, std::memory_order_relaxed);
+    }
+
+    void recordCacheMiss() noexcept
+    { cacheMisses.fetch_add(1u, std::memory_order_relaxed); }
+
+    std::atomic<std::uint64_t> errors{0u};
+    std::atomic<std::uint64_t> cacheHits{0u};
+    std::atomic<std::uint64_t> cacheMisses{0u};
+    TdbLatencyHistogram acl;
+    TdbLatencyHistogram dispatch;
+    TdbLatencyHistogram dbModule;
+
+}; /* struct TdbDataSourceSyscallStatistics { */
+
+/**
+  \brief Call counts, error counts and latencies of the syscalls of this module
+         and of the syscalls forwarded to each data source.
+
+  The set of syscalls and data sources is fixed during module initialization,
+  after which recording only touches preallocated atomic counters.
+*/
+class __attribute__ ((visibility("internal"))) TdbStatistics
+    : private ::SharemindTdbStatistics
+{
+
+public: /* Types: */
+
+    using Clock = std::chrono::steady_clock;
+
+public: /* Methods: */
+
+    /**
+      \param[in] syscalls names of the syscalls of this module.
+      \param[in] dbSyscalls names of the syscalls forwarded to the database
+                            modules.
+    */
+    TdbStatistics(LogHard::Logger const & logger,
+                  std::vector<std::string> syscalls,
+                  std::vector<std::string> dbSyscalls);
+
+    TdbSyscallStatistics & syscall(std::size_t const index) noexcept
+    { return m_syscalls[index]; }
+
+    /**
+      \brief Allocates the statistics of the forwarded syscalls of a data
+             source.
+      \returns an array indexed like the forwarded syscall names.
+    */
+    TdbDataSourceSyscallStatistics * addDataSource(std::string const & name);
+
+    /** \brief Writes all non-empty statistics to the logger. */
+    void dump() const noexcept;
+
+    void reset() noexcept;
+
+    std::uint64_t callCount(std::string const & syscall) const noexcept;
+
+    static TdbStatistics & fromWrapper(SharemindTdbStatistics & wrapper)
+            noexcept
+    { return static_cast<TdbStatistics &>(wrapper); }
+
+    inline SharemindTdbStatistics * getWrapper() { return this; }
+
+    inline const SharemindTdbStatistics * getWrapper() const { return this; }
+
+private: /* Fields: */
+
+    LogHard::Logger const m_logger;
+    std::vector<std::string> const m_syscallNames;
+    std::vector<std::string> const m_dbSyscallNames;
+    std::unique_ptr<TdbSyscallStatistics[]> const m_syscalls;
+    std::map<std::string, std::unique_ptr<TdbDataSourceSyscallStatistics[]> >
+            m_dataSources;
+
+}; /* class TdbStatistics { */
+
+} /* namespace sharemind { */
+
+#endif /* SHAREMIND_MOD_TABLEDB_TDBSTATISTICS_H */
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "TdbTableCache.h"
+
+#include <boost/variant/apply_visitor.hpp>
+#include <boost/variant/static_visitor.hpp>
+#include <cassert>
+#include "TdbVectorMap.h"
+
+
+namespace sharemind {
+
+namespace {
+
+class CopyVisitor: public boost::static_visitor<bool> {
+
+public: /* Methods: */
+
+    CopyVisitor(std::string const & key, TdbTableCache::Vectors & vectors)
+        : m_key(key)
+        , m_vectors(vectors)
+    {}
+
+    template <typename V>
+    bool operator()(TdbVectorStorage<V> const & vec) const {
+        m_vectors.emplace_back(m_key, vec);
+        return true;
+    }
+
+    bool operator()(TdbVectorStorage<SharemindTdbValue> const &) const
+    { return false; }
+
+private: /* Fields: */
+
+    std::string const & m_key;
+    TdbTableCache::Vectors & m_vectors;
+
+};
+
+class RestoreVisitor: public boost::static_visitor<> {
+
+public: /* Methods: */
+
+    RestoreVisitor(std::string const & key, TdbVectorMap & map)
+        : m_key(key)
+        , m_map(map)
+    {}
+
+    template <typename V>
+    void operator()(TdbVectorStorage<V> const & vec) const {
+        m_map.getOrCreateVector<V>(m_key) = vec;
+        m_map.updateUsage(m_key);
+    }
+
+private: /* Fields: */
+
+    std::string const & m_key;
+    TdbVectorMap & m_map;
+
+};
+
+} // anonymous namespace
+
+bool TdbTableCache::find(boost::string_view const table,
+                         Entry const entry,
+                         Result & result,
+                         std::uint64_t & generation) const
+{
+    assert(entry < NoEntry);
+    std::lock_guard<std::mutex> const guard(m_mutex);
+    auto const it(m_tables.find(table));
+    if (it != m_tables.end() && (it->second.valid & (1u << entry))) {
+        result = it->second.results[entry];
+        return true;
+    }
+    generation = m_generation;
+    return false;
+}
+
+void TdbTableCache::insert(boost::string_view const table,
+                           Entry const entry,
+                           Result result,
+                           std::uint64_t const generation)
+{
+    assert(entry < NoEntry);
+    std::lock_guard<std::mutex> const guard(m_mutex);
+    if (generation != m_generation)
+        return;
+    auto it(m_tables.find(table));
+    if (it == m_tables.end())
+        it = m_tables.emplace(table.to_string(), Table()).first;
+    auto & t = it->second;
+    t.results[entry] = std::move(result);
+    t.valid |= 1u << entry;
+}
+
+void TdbTableCache::invalidate(boost::string_view const table,
+                               unsigned const entries)
+{
+    std::lock_guard<std::mutex> const guard(m_mutex);
+    ++m_generation;
+    auto const it(m_tables.find(table));
+    if (it == m_tables.end())
+        return;
+    auto & t = it->second;
+    for (unsigned i = 0u; i < NoEntry; ++i) {
+        if (entries & t.valid & (1u << i)) {
+            t.results[i] = Result();
+            t.valid &= ~(1u << i);
+        }
+    }
+    if (!t.valid)
+        m_tables.erase(it);
+}
+
+std::shared_ptr<TdbTableCache::Vectors const> TdbTableCache::copyVectors(
+        TdbVectorMap const & map)
+{
+    if (map.batchCount() != 1u)
+        return nullptr;
+    auto vectors(std::make_shared<Vectors>());
+    bool copyable = true;
+    map.currentBatch().forEach(
+                [&vectors, &copyable](std::string const & key,
+                                      TdbVectorMapBatch::VectorVariant const & v)
+                {
+                    if (copyable)
+                        copyable = boost::apply_visitor(
+                                        CopyVisitor(key, *vectors),
+                                        v);
+                });
+    if (!copyable)
+        return nullptr;
+    return vectors;
+}
+
+void TdbTableCache::restoreVectors(Vectors const & vectors,
+                                   TdbVectorMap & map)
+{
+    for (auto const & v : vectors)
+        boost::apply_visitor(RestoreVisitor(v.first, map), v.second);
+}
+
+} /* namespace sharemind { */
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SHAREMIND_MOD_TABLEDB_TDBTABLECACHE_H
+#define SHAREMIND_MOD_TABLEDB_TDBTABLECACHE_H
+
+#include <array>
+#include <boost/utility/string_view.hpp>
+#include <boost/variant/variant.hpp>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sharemind/module-apis/api_0x1.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include "TdbVectorStorage.h"
+#include "tdbtypes.h"
+
+
+namespace sharemind {
+
+class TdbVectorMap;
+
+/**
+  \brief Cache of the results of forwarded syscalls describing the tables of a
+         data source.
+
+  Results are cached per table and dropped by the syscalls modifying the
+  table. Since the cache is shared by all processes, a result is only stored
+  if no entries were invalidated while it was being computed.
+*/
+class __attribute__ ((visibility("internal"))) TdbTableCache {
+
+public: /* Types: */
+
+    /** \brief The cacheable results of a table. */
+    enum Entry : unsigned {
+        Exists,
+        ColCount,
+        ColNames,
+        ColTypes,
+        RowCount,
+        NoEntry
+    };
+
+    enum : unsigned {
+        SchemaEntries = (1u << Exists)
+                      | (1u << ColCount)
+                      | (1u << ColNames)
+                      | (1u << ColTypes),
+        RowEntries = 1u << RowCount,
+        AllEntries = SchemaEntries | RowEntries
+    };
+
+    /** \brief How a forwarded syscall uses the cache. */
+    struct Use {
+
+        /** The entry holding the result of the syscall, if any. */
+        Entry entry;
+
+        /** The mask of entries of the table invalidated by the syscall. */
+        unsigned invalidates;
+
+    };
+
+    using Vector = boost::variant<TdbVectorStorage<SharemindTdbIndex>,
+                                  TdbVectorStorage<SharemindTdbString>,
+                                  TdbVectorStorage<SharemindTdbType> >;
+    using Vectors = std::vector<std::pair<std::string, Vector> >;
+
+    /**
+      \brief A cached result. For entries returning a vector map, the contents
+             of the vector map are kept instead of its identifier.
+    */
+    struct Result {
+        SharemindCodeBlock value;
+        std::shared_ptr<Vectors const> vectors;
+    };
+
+public: /* Methods: */
+
+    /** \returns whether the result of the entry is a vector map. */
+    static bool isVectorMapEntry(Entry const entry) noexcept
+    { return entry == ColNames || entry == ColTypes; }
+
+    /**
+      \brief Looks up a cached result.
+      \param[out] generation set on a miss, to be given to insert().
+      \returns whether the result was found.
+    */
+    bool find(boost::string_view table,
+              Entry entry,
+              Result & result,
+              std::uint64_t & generation) const;
+
+    /**
+      \brief Caches a result unless entries have been invalidated since the
+             lookup which returned the given generation.
+    */
+    void insert(boost::string_view table,
+                Entry entry,
+                Result result,
+                std::uint64_t generation);
+
+    /** \brief Drops the given mask of entries of the table. */
+    void invalidate(boost::string_view table, unsigned entries);
+
+    /**
+      \returns a copy of the contents of the vector map or nullptr if the
+               vector map has several batches or contains value vectors.
+    */
+    static std::shared_ptr<Vectors const> copyVectors(TdbVectorMap const & map);
+
+    /** \brief Copies the vectors into the current batch of the vector map. */
+    static void restoreVectors(Vectors const & vectors, TdbVectorMap & map);
+
+private: /* Types: */
+
+    struct Table {
+        unsigned valid = 0u;
+        std::array<Result, NoEntry> results;
+    };
+
+private: /* Fields: */
+
+    mutable std::mutex m_mutex;
+    std::uint64_t m_generation = 0u;
+    std::map<std::string, Table, std::less<> > m_tables;
+
+}; /* class TdbTableCache { */
+
+} /* namespace sharemind { */
+
+#endif /* SHAREMIND_MOD_TABLEDB_TDBTABLECACHE_H */
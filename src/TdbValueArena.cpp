@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "TdbValueArena.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <system_error>
+#include <unistd.h>
+
+
+namespace sharemind {
+
+/** \brief An unlinked temporary file mapped into memory. */
+class TdbValueArena::SpillFile {
+
+public: /* Methods: */
+
+    /** \throws std::system_error if the file could not be created. */
+    SpillFile(std::string const & directory, std::uint64_t const capacity) {
+        std::string path(directory);
+        path += "/tdb-spill-XXXXXX";
+        m_fd = ::mkostemp(&path[0u], O_CLOEXEC);
+        if (m_fd < 0)
+            throw std::system_error(errno,
+                                    std::system_category(),
+                                    "Failed to create spill file");
+        ::unlink(path.c_str());
+        try {
+            reserve(capacity);
+        } catch (...) {
+            ::close(m_fd);
+            throw;
+        }
+    }
+
+    SpillFile(SpillFile const &) = delete;
+    SpillFile & operator=(SpillFile const &) = delete;
+
+    ~SpillFile() noexcept {
+        if (m_data)
+            ::munmap(m_data, m_capacity);
+        ::close(m_fd);
+    }
+
+    unsigned char * data() const noexcept { return m_data; }
+
+    std::uint64_t size() const noexcept { return m_size; }
+
+    void setSize(std::uint64_t const size) noexcept {
+        assert(size <= m_capacity);
+        m_size = size;
+    }
+
+    std::uint64_t capacity() const noexcept { return m_capacity; }
+
+    /**
+      \brief Grows the file and its mapping. The file blocks are allocated
+             up front, so that running out of disk space is reported here
+             instead of by a signal on access.
+      \throws std::bad_alloc if the file could not be grown.
+    */
+    void reserve(std::uint64_t newCapacity) {
+        if (newCapacity <= m_capacity)
+            return;
+        static std::uint64_t const pageSize =
+                static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+        newCapacity = (newCapacity + pageSize - 1u) / pageSize * pageSize;
+        if (::posix_fallocate(m_fd,
+                              static_cast<off_t>(m_capacity),
+                              static_cast<off_t>(newCapacity - m_capacity)))
+            throw std::bad_alloc();
+        void * const p =
+                m_data
+                ? ::mremap(m_data, m_capacity, newCapacity, MREMAP_MAYMOVE)
+                : ::mmap(nullptr,
+                         newCapacity,
+                         PROT_READ | PROT_WRITE,
+                         MAP_SHARED,
+                         m_fd,
+                         0);
+        if (p == MAP_FAILED) {
+            static_cast<void>(
+                        ::ftruncate(m_fd, static_cast<off_t>(m_capacity)));
+            throw std::bad_alloc();
+        }
+        m_data = static_cast<unsigned char *>(p);
+        m_capacity = newCapacity;
+    }
+
+private: /* Fields: */
+
+    int m_fd;
+    unsigned char * m_data = nullptr;
+    std::uint64_t m_capacity = 0u;
+    std::uint64_t m_size = 0u;
+
+}; /* class TdbValueArena::SpillFile { */
+
+TdbValueArena::TdbValueArena() noexcept = default;
+TdbValueArena::TdbValueArena(TdbValueArena &&) noexcept = default;
+TdbValueArena & TdbValueArena::operator=(TdbValueArena &&) noexcept = default;
+TdbValueArena::~TdbValueArena() noexcept = default;
+
+unsigned char * TdbValueArena::data() noexcept
+{ return m_file ? m_file->data() : m_memory.data(); }
+
+unsigned char const * TdbValueArena::data() const noexcept
+{ return m_file ? m_file->data() : m_memory.data(); }
+
+std::uint64_t TdbValueArena::size() const noexcept
+{ return m_file ? m_file->size() : m_memory.size(); }
+
+std::uint64_t TdbValueArena::capacity() const noexcept
+{ return m_file ? m_file->capacity() : m_memory.capacity(); }
+
+void TdbValueArena::reserve(std::uint64_t const newCapacity) {
+    if (newCapacity <= capacity())
+        return;
+    if (m_file) {
+        m_file->reserve(newCapacity);
+    } else if (!m_policy
+               || !m_policy->spills(newCapacity)
+               || !spill(newCapacity))
+    {
+        m_memory.reserve(newCapacity);
+    }
+}
+
+void TdbValueArena::resize(std::uint64_t const newSize) {
+    if (newSize > capacity())
+        reserve(std::max(newSize, capacity() * 2u));
+    if (m_file) {
+        m_file->setSize(newSize);
+    } else {
+        m_memory.resize(newSize);
+    }
+}
+
+void TdbValueArena::assign(unsigned char const * const first,
+                           unsigned char const * const last)
+{
+    assert(first <= last);
+    if (m_file) {
+        m_file->setSize(0u);
+    } else {
+        m_memory.clear();
+    }
+    auto const n = static_cast<std::uint64_t>(last - first);
+    resize(n);
+    if (n)
+        std::memcpy(data(), first, n);
+}
+
+void TdbValueArena::clear() noexcept {
+    m_file.reset();
+    m_memory.clear();
+}
+
+bool TdbValueArena::spill(std::uint64_t const newCapacity) noexcept {
+    assert(m_policy);
+    assert(!m_file);
+    try {
+        std::unique_ptr<SpillFile> file(
+                    new SpillFile(m_policy->directory, newCapacity));
+        if (!m_memory.empty())
+            std::memcpy(file->data(), m_memory.data(), m_memory.size());
+        file->setSize(m_memory.size());
+        std::vector<unsigned char>().swap(m_memory);
+        m_file = std::move(file);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+} /* namespace sharemind { */
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SHAREMIND_MOD_TABLEDB_TDBVALUEARENA_H
+#define SHAREMIND_MOD_TABLEDB_TDBVALUEARENA_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace sharemind {
+
+/** \brief When and where value vector payloads are spilled to disk. */
+struct __attribute__ ((visibility("internal"))) TdbSpillPolicy {
+
+    /** \returns whether an arena of the given size is to be spilled. */
+    bool spills(std::uint64_t const arenaSize) const noexcept
+    { return threshold && arenaSize > threshold; }
+
+    /** The directory in which the spill files are created. */
+    std::string directory;
+
+    /** The arena size in bytes above which payloads are spilled, 0 if never. */
+    std::uint64_t threshold;
+
+}; /* struct TdbSpillPolicy { */
+
+/**
+  \brief The byte arena holding the payloads of a value vector.
+
+  The arena is kept in memory until a spill policy is set and the arena grows
+  beyond its threshold, after which the payloads are moved to an unlinked
+  temporary file mapped into memory. Pointers into the arena remain valid until
+  it is modified. If the spill file can not be created, the arena stays in
+  memory.
+*/
+class __attribute__ ((visibility("internal"))) TdbValueArena {
+
+public: /* Methods: */
+
+    TdbValueArena() noexcept;
+    TdbValueArena(TdbValueArena &&) noexcept;
+    TdbValueArena & operator=(TdbValueArena &&) noexcept;
+    ~TdbValueArena() noexcept;
+
+    void setSpillPolicy(std::shared_ptr<TdbSpillPolicy const> policy) noexcept
+    { m_policy = std::move(policy); }
+
+    unsigned char * data() noexcept;
+    unsigned char const * data() const noexcept;
+
+    std::uint64_t size() const noexcept;
+    std::uint64_t capacity() const noexcept;
+
+    /** \returns whether the payloads reside in a spill file. */
+    bool spilled() const noexcept { return static_cast<bool>(m_file); }
+
+    /** \returns whether growing to the given size keeps the arena on disk. */
+    bool spills(std::uint64_t const newSize) const noexcept
+    { return m_file || (m_policy && m_policy->spills(newSize)); }
+
+    /** \returns the memory held by the arena, excluding a spill file. */
+    std::uint64_t residentBytes() const noexcept
+    { return m_file ? 0u : m_memory.capacity(); }
+
+    void reserve(std::uint64_t newCapacity);
+
+    /** \brief Resizes the arena, growing geometrically. */
+    void resize(std::uint64_t newSize);
+
+    void assign(unsigned char const * first, unsigned char const * last);
+
+    /** \brief Empties the arena, removing its spill file if any. */
+    void clear() noexcept;
+
+private: /* Types: */
+
+    class SpillFile;
+
+private: /* Methods: */
+
+    /**
+      \brief Moves the arena into a new spill file of the given capacity.
+      \returns whether the arena was spilled.
+    */
+    bool spill(std::uint64_t newCapacity) noexcept;
+
+private: /* Fields: */
+
+    std::vector<unsigned char> m_memory;
+    std::unique_ptr<SpillFile> m_file;
+    std::shared_ptr<TdbSpillPolicy const> m_policy;
+
+}; /* class TdbValueArena { */
+
+} /* namespace sharemind { */
+
+#endif /* SHAREMIND_MOD_TABLEDB_TDBVALUEARENA_H */
@@ -19,7 +19,6 @@
 
 #include "TdbVectorMap.h"
 
-#include <boost/assign/ptr_list_of.hpp>
 #include <cassert>
 
 
@@ -31,6 +30,8 @@ extern "C" {
         return TDB_VECTOR_MAP_VALUE_NOT_FOUND; \
     } catch (const sharemind::TdbVectorMap::TypeException &) { \
         return TDB_VECTOR_MAP_TYPE_ERROR; \
+    } catch (const sharemind::TdbVectorMap::QuotaException &) { \
+        return TDB_VECTOR_MAP_QUOTA_EXCEEDED; \
     } catch (const sharemind::TdbVectorMap::Exception &) { \
         return TDB_VECTOR_MAP_GENERAL_ERROR; \
     } catch (const std::bad_alloc &) { \
@@ -365,12 +366,49 @@ uint64_t SharemindTdbVectorMap_get_id(SharemindTdbVectorMap * map) {
     return sharemind::TdbVectorMap::fromWrapper(*map).getId();
 }
 
+SharemindTdbVectorMapError SharemindTdbVectorMap_set_external_value_vector(
+        SharemindTdbVectorMap * map,
+        const char * key,
+        const SharemindTdbType * type,
+        const void * buffer,
+        const uint64_t * offsets,
+        const size_t size,
+        SharemindTdbVectorMapReleaseFn release,
+        void * context);
+SharemindTdbVectorMapError SharemindTdbVectorMap_set_external_value_vector(
+        SharemindTdbVectorMap * map,
+        const char * key,
+        const SharemindTdbType * type,
+        const void * buffer,
+        const uint64_t * offsets,
+        const size_t size,
+        SharemindTdbVectorMapReleaseFn release,
+        void * context)
+{
+    assert(map);
+    assert(key);
+    assert(type);
+    try {
+        auto & m = sharemind::TdbVectorMap::fromWrapper(*map);
+        m.setExternalValueVector(key,
+                                 *type,
+                                 buffer,
+                                 offsets,
+                                 size,
+                                 release,
+                                 context);
+        return TDB_VECTOR_MAP_OK;
+    } TDB_VECTOR_MAP_CATCH_ALL;
+}
+
 } // extern "C" {
 } // anonymous namespace
 
 namespace sharemind {
 
-TdbVectorMap::TdbVectorMap(const uint64_t id)
+TdbVectorMap::TdbVectorMap(const uint64_t id,
+                           std::shared_ptr<TdbMemoryAccount> account,
+                           std::shared_ptr<TdbSpillPolicy const> spillPolicy)
     : ::SharemindTdbVectorMap{&SharemindTdbVectorMap_get_index_vector,
                               &SharemindTdbVectorMap_set_index_vector,
                               &SharemindTdbVectorMap_is_index_vector,
@@ -390,10 +428,43 @@ TdbVectorMap::TdbVectorMap(const uint64_t id)
                               &SharemindTdbVectorMap_add_batch,
                               &SharemindTdbVectorMap_batch_count,
                               &SharemindTdbVectorMap_reset,
-                              &SharemindTdbVectorMap_get_id}
+                              &SharemindTdbVectorMap_get_id,
+                              &SharemindTdbVectorMap_set_external_value_vector}
     , m_id{id}
-    , m_batches{boost::ptr_vector<AnyValueMap>(boost::assign::ptr_list_of<AnyValueMap>())}
     , m_currentBatchNumber{0u}
-{}
+    , m_account{std::move(account)}
+    , m_spillPolicy{std::move(spillPolicy)}
+{ addBatch(); }
+
+TdbVectorMap::~TdbVectorMap() noexcept {
+    if (m_account)
+        m_account->release(m_bytes);
+}
+
+void TdbVectorMap::updateUsage() noexcept {
+    auto const bytes = currentBatch().bytes();
+    auto & old = m_batchBytes[m_currentBatchNumber];
+    if (m_account) {
+        if (bytes > old) {
+            m_account->charge(bytes - old);
+        } else {
+            m_account->release(old - bytes);
+        }
+    }
+    m_bytes = m_bytes - old + bytes;
+    old = bytes;
+}
+
+uint64_t TdbVectorMap::residentPayloadBytes(const SharemindTdbValue *,
+                                            const boost::string_view key,
+                                            const uint64_t bytes)
+        const noexcept
+{
+    auto const * const it = currentBatch().find(key);
+    if (it)
+        if (auto const * const vec = boost::get<Vector<SharemindTdbValue> >(it))
+            return vec->residentPayloadBytes(bytes);
+    return (m_spillPolicy && m_spillPolicy->spills(bytes)) ? 0u : bytes;
+}
 
 } /* namespace sharemind { */
@@ -20,112 +20,29 @@
 #ifndef SHAREMIND_MOD_TABLEDB_TDBVECTORMAP_H
 #define SHAREMIND_MOD_TABLEDB_TDBVECTORMAP_H
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
 #include <stdexcept>
-#include <typeinfo>
-#include <map>
+#include <string>
 #include <vector>
-#include <boost/any.hpp>
-#include <boost/checked_delete.hpp>
-#include <boost/ptr_container/clone_allocator.hpp>
 #include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/utility/string_view.hpp>
+#include <boost/variant/get.hpp>
 
+#include "TdbMemoryAccount.h"
 #include "TdbTypesUtil.h"
+#include "TdbValueArena.h"
+#include "TdbVectorMapBatch.h"
+#include "TdbVectorStorage.h"
 #include "tdbtypes.h"
 #include "tdbvectormapapi.h"
 
 
 namespace sharemind {
 
-// We want a custom clone allocator and deleter for some of the types, however
-// we don't want to propagate the new_clone and delete_clone functions to all
-// the other ptr_containers used elsewhere.
-struct tdb_heap_clone_allocator {
-public: /* Methods: */
-
-    template<class U>
-    static U * allocate_clone(const U & r) {
-        return new_clone(r);
-    }
-
-    template<class U>
-    static void deallocate_clone(const U * r) {
-        delete_clone(r);
-    }
-
-private: /* Methods: */
-
-    template<class T>
-    static inline T * new_clone(const T & r) {
-        return boost::new_clone(r);
-    }
-
-    template<class T>
-    static inline T * new_clone(const T * r) {
-        return boost::new_clone(r);
-    }
-
-    template<class T>
-    static inline void delete_clone(const T * r) {
-        boost::delete_clone(r);
-    }
-
-    static inline SharemindTdbString * new_clone(const SharemindTdbString & r) {
-        SharemindTdbString * res = new SharemindTdbString;
-
-        const size_t len = strlen(r.str);
-        res->str = new char[len + 1];
-        strncpy(res->str, r.str, len + 1);
-
-        return res;
-    }
-
-    static inline void delete_clone(const SharemindTdbString * r) {
-        delete[] r->str;
-        boost::checked_delete(r);
-    }
-
-    static inline SharemindTdbType * new_clone(const SharemindTdbType & r) {
-        SharemindTdbType * res = new SharemindTdbType(r);
-
-        if (r.domain) {
-            size_t len = strlen(r.domain);
-            res->domain = new char[len + 1];
-            strncpy(res->domain, r.domain, len + 1);
-        }
-        if (r.name) {
-            size_t len = strlen(r.name);
-            res->name = new char[len + 1];
-            strncpy(res->name, r.name, len + 1);
-        }
-
-        return res;
-    }
-
-    static inline void delete_clone(const SharemindTdbType * r) {
-        delete[] r->domain;
-        delete[] r->name;
-        boost::checked_delete(r);
-    }
-
-    static inline SharemindTdbValue * new_clone(const SharemindTdbValue & r) {
-        SharemindTdbValue * res = new SharemindTdbValue;
-
-        res->type = new_clone(*r.type);
-        res->buffer = ::operator new(r.size);
-        memcpy(res->buffer, r.buffer, r.size);
-        res->size = r.size;
-
-        return res;
-    }
-
-    static inline void delete_clone(const SharemindTdbValue * r) {
-        ::operator delete(r->buffer);
-        delete_clone(r->type);
-        boost::checked_delete(r);
-    }
-
-};
-
 class __attribute__ ((visibility("internal"))) TdbVectorMap
     : private ::SharemindTdbVectorMap
 {
@@ -159,183 +76,239 @@ public: /* Types: */
 
     };
 
-private: /* Types: */
+    class __attribute__ ((visibility("internal"))) QuotaException: public Exception {
+    public: /* Methods: */
 
-    typedef std::map<std::string, boost::any> AnyValueMap;
+        inline QuotaException(const std::string & msg)
+            : Exception(msg)
+        { }
 
-    typedef tdb_heap_clone_allocator CA;
+    };
+
+public: /* Types: */
+
+    using Batch = TdbVectorMapBatch;
+
+    template <typename V>
+    using Vector = TdbVectorStorage<V>;
 
 public: /* Methods: */
 
-    TdbVectorMap(const uint64_t id);
+    /**
+      \param[in] account the memory account of the process holding the map, or
+                         nullptr if the memory held by the map is not limited.
+      \param[in] spillPolicy the spill policy of new value vectors, or nullptr
+                             if their payloads are kept in memory.
+    */
+    TdbVectorMap(const uint64_t id,
+                 std::shared_ptr<TdbMemoryAccount> account = nullptr,
+                 std::shared_ptr<TdbSpillPolicy const> spillPolicy = nullptr);
+    ~TdbVectorMap() noexcept;
 
     template<typename V>
-    typename boost::ptr_vector<V, CA>::size_type size(const std::string & key) const {
+    Vector<V> & getVector(const boost::string_view key) {
         // Check if the vector exists
-        auto const & cb = currentBatch();
-        auto const it = cb.find(key);
-        if (it == cb.end())
-            throw NotFoundException("Failed to get \"" + key + "\": vector not found.");
+        auto * const it = currentBatch().find(key);
+        if (!it)
+            throw NotFoundException("Failed to get \"" + key.to_string() + "\": vector not found.");
 
         // Check if the vector has the right type
-        const boost::ptr_vector<V, CA> * vec = boost::any_cast<boost::ptr_vector<V, CA> >(&it->second);
+        Vector<V> * vec = boost::get<Vector<V> >(it);
         if (!vec)
-            throw TypeException("Failed to get \"" + key + "\": Stored type does not match the expected type.");
-        return vec->size();
+            throw TypeException("Failed to get \"" + key.to_string() + "\": Stored type does not match the expected type.");
+        return *vec;
     }
 
     template<typename V>
-    typename boost::ptr_vector<V, CA>::reference at(const std::string & key, typename boost::ptr_vector<V, CA>::size_type n) {
+    Vector<V> const & getVector(const boost::string_view key) const {
         // Check if the vector exists
-        auto & cb = currentBatch();
-        auto const it = cb.find(key);
-        if (it == cb.end())
-            throw NotFoundException("Failed to get \"" + key + "\": vector not found.");
+        auto const * const it = currentBatch().find(key);
+        if (!it)
+            throw NotFoundException("Failed to get \"" + key.to_string() + "\": vector not found.");
 
         // Check if the vector has the right type
-        boost::ptr_vector<V, CA> * vec = boost::any_cast<boost::ptr_vector<V, CA> >(&it->second);
+        const Vector<V> * vec = boost::get<Vector<V> >(it);
         if (!vec)
-            throw TypeException("Failed to get \"" + key + "\": Stored type does not match the expected type.");
-        return vec->at(n);
+            throw TypeException("Failed to get \"" + key.to_string() + "\": Stored type does not match the expected type.");
+        return *vec;
     }
 
     template<typename V>
-    typename boost::ptr_vector<V, CA>::const_reference at(const std::string & key, typename boost::ptr_vector<V, CA>::size_type n) const {
-        // Check if the vector exists
-        auto const & cb = currentBatch();
-        auto const it = cb.find(key);
-        if (it == cb.end())
-            throw NotFoundException("Failed to get \"" + key + "\": vector not found.");
+    Vector<V> & getOrCreateVector(const boost::string_view key) {
+        // Get the vector or insert a new one
+        auto const rv = currentBatch().emplace<V>(key);
 
         // Check if the vector has the right type
-        const boost::ptr_vector<V, CA> * vec = boost::any_cast<boost::ptr_vector<V, CA> >(&it->second);
+        Vector<V> * vec = boost::get<Vector<V> >(rv.first);
         if (!vec)
-            throw TypeException("Failed to get \"" + key + "\": Stored type does not match the expected type.");
-        return vec->at(n);
+            throw TypeException("Failed to get \"" + key.to_string() + "\": Stored type does not match the expected type.");
+        if (rv.second)
+            initVector(*vec);
+        return *vec;
     }
 
     template<typename V>
-    void push_back(const std::string & key, V * val) {
-        // Check if the vector exists
-        auto & cb = currentBatch();
-        auto it = cb.find(key);
-        if (it == cb.end()) {
-            auto const rv =
-                    cb.insert(AnyValueMap::value_type(key, boost::ptr_vector<V, CA>()));
-            if (!rv.second)
-                throw Exception("Failed to store vector \"" + key + "\".");
-
-            it = rv.first;
-        }
+    typename Vector<V>::size_type size(const boost::string_view key) const
+    { return getVector<V>(key).size(); }
 
-        // Check if the vector has the right type
-        boost::ptr_vector<V, CA> * vec = boost::any_cast<boost::ptr_vector<V, CA> >(&it->second);
-        if (!vec)
-            throw TypeException("Failed to get \"" + key + "\": Stored type does not match the expected type.");
-        vec->push_back(val);
-    }
+    template<typename V>
+    typename Vector<V>::reference at(const boost::string_view key, typename Vector<V>::size_type n)
+    { return getVector<V>(key).at(n); }
 
     template<typename V>
-    void pop_back(const std::string & key) {
-        // Check if the vector exists
-        auto & cb = currentBatch();
-        auto const it = cb.find(key);
-        if (it == cb.end())
-            throw NotFoundException("Failed to get \"" + key + "\": vector not found.");
+    typename Vector<V>::const_reference at(const boost::string_view key, typename Vector<V>::size_type n) const
+    { return getVector<V>(key).at(n); }
 
-        // Check if the vector has the right type
-        boost::ptr_vector<V, CA> * vec = boost::any_cast<boost::ptr_vector<V, CA> >(&it->second);
-        if (!vec)
-            throw TypeException("Failed to get \"" + key + "\": Stored type does not match the expected type.");
-        vec->pop_back();
+    /**
+      \returns the number of bytes of the given payload size which would be
+               held in memory if appended to the vector.
+    */
+    template<typename V>
+    uint64_t residentPayloadBytes(const boost::string_view key, const uint64_t bytes) const noexcept
+    { return residentPayloadBytes(static_cast<V const *>(nullptr), key, bytes); }
+
+    /**
+      \returns the number of bytes which appending n elements with the given
+               total payload size to the vector would hold in memory,
+               including the offsets and type indexes kept for every element.
+      \throws Exception if no vector can hold that many elements.
+    */
+    template<typename V>
+    uint64_t appendBytes(const boost::string_view key, const uint64_t n, const uint64_t bytes) const {
+        auto const resident = residentPayloadBytes<V>(key, bytes);
+        if (n > maxElements
+            || n > (std::numeric_limits<uint64_t>::max() - resident)
+                   / (Vector<V>::elementBytes + 1u))
+            throw Exception("Failed to grow \"" + key.to_string() + "\": too many elements.");
+        return resident + n * Vector<V>::elementBytes;
     }
 
     template<typename V>
-    void clear(const std::string & key) {
-        // Check if the vector exists
-        auto & cb = currentBatch();
-        auto const it = cb.find(key);
-        if (it == cb.end())
-            throw NotFoundException("Failed to get \"" + key + "\": vector not found.");
+    void push_back(const boost::string_view key, V * val) {
+        checkQuota(appendBytes<V>(key, 1u, payloadBytes(*val)));
+        getOrCreateVector<V>(key).push_back(val);
+        updateUsage(key);
+    }
 
-        // Check if the vector has the right type
-        boost::ptr_vector<V, CA> * vec = boost::any_cast<boost::ptr_vector<V, CA> >(&it->second);
-        if (!vec)
-            throw TypeException("Failed to get \"" + key + "\": Stored type does not match the expected type.");
-        vec->clear();
+    template<typename V>
+    void pop_back(const boost::string_view key) {
+        getVector<V>(key).pop_back();
+        updateUsage(key);
     }
 
     template<typename V>
-    bool count(const std::string & key) const {
+    void clear(const boost::string_view key) {
+        getVector<V>(key).clear();
+        updateUsage(key);
+    }
+
+    template<typename V>
+    bool count(const boost::string_view key) const {
         // Check if the vector exists
-        auto const & cb = currentBatch();
-        auto const it = cb.find(key);
-        if (it == cb.end())
+        auto const * const it = currentBatch().find(key);
+        if (!it)
             return false;
 
         // Check if the vector has the right type
-        return it->second.type() == typeid(boost::ptr_vector<V, CA>);
+        return boost::get<Vector<V> >(it);
     }
 
-    bool count(const std::string & key) const {
+    bool count(const boost::string_view key) const {
         // Check if the vector exists
-        auto const & cb = currentBatch();
-        return cb.find(key) != cb.end();
+        return currentBatch().find(key);
     }
 
-    bool erase(const std::string & key) { return currentBatch().erase(key); }
+    bool erase(const boost::string_view key) {
+        bool const r = currentBatch().erase(key);
+        updateUsage();
+        return r;
+    }
 
-    void clear() { currentBatch().clear(); }
+    void clear() {
+        currentBatch().clear();
+        updateUsage();
+    }
 
     template<typename V>
-    void getCArray(const std::string & key, V **& array, typename boost::ptr_vector<V, CA>::size_type & size) {
-        // Check if the vector exists
-        auto & cb = currentBatch();
-        auto const it = cb.find(key);
-        if (it == cb.end())
-            throw NotFoundException("Failed to get \"" + key + "\": vector not found.");
-
-        // Check if the vector has the right type
-        boost::ptr_vector<V, CA> * vec = boost::any_cast<boost::ptr_vector<V, CA> >(&it->second);
-        if (!vec)
-            throw TypeException("Failed to get \"" + key + "\": Stored type does not match the expected type.");
-
-        array = vec->c_array();
-        size = vec->size();
-    }
+    void getCArray(const boost::string_view key, V **& array, typename Vector<V>::size_type & size)
+    { getVector<V>(key).getCArray(array, size); }
 
     template<typename V>
-    void setCArray(const std::string & key, V ** array, typename boost::ptr_vector<V, CA>::size_type size) {
+    void setCArray(const boost::string_view key, V ** array, typename Vector<V>::size_type size) {
+        uint64_t bytes = 0u;
+        for (typename Vector<V>::size_type i = 0u; i < size; ++i)
+            bytes += payloadBytes(*array[i]);
+        checkQuota(appendBytes<V>(key, size, bytes));
+
         // Check if the vector exists
         auto & cb = currentBatch();
-        auto it = cb.find(key);
-        if (it != cb.end())
-            throw Exception("Failed to store \"" + key + "\": vector already exists.");
-
-        std::pair<AnyValueMap::iterator, bool> rv =
-            cb.insert(AnyValueMap::value_type(key, boost::ptr_vector<V, CA>()));
+        auto const rv = cb.emplace<V>(key);
         if (!rv.second)
-            throw Exception("Failed to store vector \"" + key + "\".");
+            throw Exception("Failed to store \"" + key.to_string() + "\": vector already exists.");
+
+        try {
+            auto & vec = boost::get<Vector<V> >(*rv.first);
+            initVector(vec);
+            vec.setCArray(array, size);
+        } catch (...) {
+            cb.erase(key);
+            throw;
+        }
+        updateUsage(key);
+    }
 
-        it = rv.first;
+    /**
+      \brief Stores values whose payloads reside in an external buffer as a new
+             value vector.
+      \see TdbVectorStorage<SharemindTdbValue>::setExternal()
+    */
+    void setExternalValueVector(const boost::string_view key,
+                                const SharemindTdbType & type,
+                                const void * data,
+                                const uint64_t * offsets,
+                                Vector<SharemindTdbValue>::size_type size,
+                                void (* release)(void * context),
+                                void * context)
+    {
+        if (offsets)
+            for (Vector<SharemindTdbValue>::size_type i = 0u; i < size; ++i)
+                if (offsets[i] > offsets[i + 1u])
+                    throw Exception("Failed to store \"" + key.to_string() + "\": payload offsets are not ascending.");
+        if (size > maxElements)
+            throw Exception("Failed to store \"" + key.to_string() + "\": too many elements.");
+        checkQuota((offsets ? offsets[size] - offsets[0u] : type.size * size)
+                   + size * Vector<SharemindTdbValue>::elementBytes);
 
-        // Check if the vector has the right type
-        boost::ptr_vector<V, CA> * vec = boost::any_cast<boost::ptr_vector<V, CA> >(&it->second);
-        if (!vec)
-            throw TypeException("Failed to get \"" + key + "\": Stored type does not match the expected type.");
-        vec->transfer(vec->begin(), array, size);
+        // Check if the vector exists
+        auto & cb = currentBatch();
+        auto const rv = cb.emplace<SharemindTdbValue>(key);
+        if (!rv.second)
+            throw Exception("Failed to store \"" + key.to_string() + "\": vector already exists.");
+
+        try {
+            auto & vec = boost::get<Vector<SharemindTdbValue> >(*rv.first);
+            initVector(vec);
+            vec.setExternal(type, data, offsets, size, release, context);
+        } catch (...) {
+            cb.erase(key);
+            throw;
+        }
+        updateUsage(key);
     }
 
-    std::vector<AnyValueMap>::size_type currentBatchNumber() const noexcept
+    std::size_t currentBatchNumber() const noexcept
     { return m_currentBatchNumber; }
 
-    AnyValueMap & currentBatch() noexcept
+    Batch & currentBatch() noexcept
     { return m_batches[m_currentBatchNumber]; }
 
-    AnyValueMap const & currentBatch() const noexcept
+    Batch const & currentBatch() const noexcept
     { return m_batches[m_currentBatchNumber]; }
 
-    inline void setBatch(const std::vector<AnyValueMap>::size_type n) {
+    Batch const & batch(const std::size_t n) const noexcept
+    { return m_batches[n]; }
+
+    inline void setBatch(const std::size_t n) {
         if (n >= m_batches.size())
             throw Exception("Failed to set batch: batch number out of range.");
 
@@ -344,21 +317,57 @@ public: /* Methods: */
 
     inline void addBatch() {
         auto const newCurrentBatchNumber = m_batches.size();
-        m_batches.push_back(new AnyValueMap);
+        m_batchBytes.push_back(0u);
+        try {
+            m_batches.push_back(new Batch);
+        } catch (...) {
+            m_batchBytes.pop_back();
+            throw;
+        }
         m_currentBatchNumber = newCurrentBatchNumber;
+        updateUsage();
     }
 
-    inline std::vector<AnyValueMap>::size_type batchCount() const {
+    inline std::size_t batchCount() const {
         return m_batches.size();
     }
 
     inline void reset() {
         m_batches.clear();
+        m_batchBytes.clear();
+        if (m_account)
+            m_account->release(m_bytes);
+        m_bytes = 0u;
         addBatch();
     }
 
     inline uint64_t getId() const noexcept { return m_id; }
 
+    /** \returns the memory held by all batches when last accounted. */
+    inline uint64_t bytes() const noexcept { return m_bytes; }
+
+    /**
+      \brief Checks that the process may hold the given number of bytes more.
+      \throws QuotaException if the memory quota of the process would be
+              exceeded.
+    */
+    void checkQuota(const uint64_t bytes) const {
+        if (m_account && !m_account->allows(bytes))
+            throw QuotaException("Failed to grow vector map: memory quota of "
+                                 + std::to_string(m_account->quota())
+                                 + " bytes exceeded.");
+    }
+
+    /**
+      \brief Accounts the memory held by the vector with the given key in the
+             current batch. Must be called after modifying a vector obtained
+             by getVector() or getOrCreateVector().
+    */
+    void updateUsage(const boost::string_view key) noexcept {
+        currentBatch().updateBytes(key);
+        updateUsage();
+    }
+
     static TdbVectorMap & fromWrapper(::SharemindTdbVectorMap & wrapper)
             noexcept
     { return static_cast<TdbVectorMap &>(wrapper); }
@@ -366,11 +375,50 @@ public: /* Methods: */
     SharemindTdbVectorMap * getWrapper() noexcept { return this; }
     SharemindTdbVectorMap const * getWrapper() const noexcept { return this; }
 
+private: /* Methods: */
+
+    /** \brief Accounts the change in the memory held by the current batch. */
+    void updateUsage() noexcept;
+
+    /* The element containers of the vectors hold at most this many elements: */
+    static constexpr uint64_t maxElements =
+            std::numeric_limits<std::ptrdiff_t>::max() / sizeof(uint64_t);
+
+    template<typename V>
+    void initVector(Vector<V> &) noexcept {}
+
+    void initVector(Vector<SharemindTdbValue> & vec) noexcept
+    { vec.setSpillPolicy(m_spillPolicy); }
+
+    template<typename V>
+    uint64_t residentPayloadBytes(const V *, const boost::string_view, const uint64_t bytes) const noexcept
+    { return bytes; }
+
+    uint64_t residentPayloadBytes(const SharemindTdbValue *, const boost::string_view key, const uint64_t bytes) const noexcept;
+
+    static uint64_t payloadBytes(const SharemindTdbIndex &) noexcept
+    { return sizeof(SharemindTdbIndex); }
+
+    static uint64_t payloadBytes(const SharemindTdbString & str) noexcept
+    { return std::strlen(str.str) + 1u; }
+
+    static uint64_t payloadBytes(const SharemindTdbType & type) noexcept {
+        return (type.domain ? std::strlen(type.domain) + 1u : 0u)
+               + (type.name ? std::strlen(type.name) + 1u : 0u);
+    }
+
+    static uint64_t payloadBytes(const SharemindTdbValue & val) noexcept
+    { return val.size; }
+
 private: /* Fields: */
 
     uint64_t m_id;
-    boost::ptr_vector<AnyValueMap> m_batches;
-    boost::ptr_vector<AnyValueMap>::size_type m_currentBatchNumber;
+    boost::ptr_vector<Batch> m_batches;
+    boost::ptr_vector<Batch>::size_type m_currentBatchNumber;
+    std::shared_ptr<TdbMemoryAccount> const m_account;
+    std::shared_ptr<TdbSpillPolicy const> const m_spillPolicy;
+    std::vector<uint64_t> m_batchBytes;
+    uint64_t m_bytes = 0u;
 
 }; /* class TdbVectorMap { */
 
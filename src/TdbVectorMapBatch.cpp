@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "TdbVectorMapBatch.h"
+
+#include <boost/variant/apply_visitor.hpp>
+#include <boost/variant/static_visitor.hpp>
+#include <cassert>
+
+
+namespace sharemind {
+
+namespace {
+
+constexpr std::size_t minCapacity = 8u;
+
+struct BytesVisitor: boost::static_visitor<std::uint64_t> {
+    template <typename Vector>
+    std::uint64_t operator()(Vector const & vector) const noexcept
+    { return vector.bytes(); }
+};
+
+} // anonymous namespace
+
+TdbVectorMapBatch::VectorVariant * TdbVectorMapBatch::find(
+        boost::string_view const key) noexcept
+{
+    Slot * const slot = findSlot(key, hashKey(key));
+    return slot ? &slot->entry->vector : nullptr;
+}
+
+TdbVectorMapBatch::VectorVariant const * TdbVectorMapBatch::find(
+        boost::string_view const key) const noexcept
+{ return const_cast<TdbVectorMapBatch *>(this)->find(key); }
+
+bool TdbVectorMapBatch::erase(boost::string_view const key) noexcept {
+    Slot * const slot = findSlot(key, hashKey(key));
+    if (!slot)
+        return false;
+
+    // Backward shift deletion:
+    auto const mask = m_slots.size() - 1u;
+    auto i = static_cast<std::size_t>(slot - m_slots.data());
+    m_bytes -= entryBytes(*m_slots[i].entry);
+    m_slots[i].entry.reset();
+    for (auto j = (i + 1u) & mask; m_slots[j].entry; j = (j + 1u) & mask) {
+        auto const home = static_cast<std::size_t>(m_slots[j].hash) & mask;
+        // Move the entry back unless its home slot lies cyclically in (i, j]:
+        bool const stays = (i <= j) ? (i < home && home <= j)
+                                    : (i < home || home <= j);
+        if (stays)
+            continue;
+        m_slots[i] = std::move(m_slots[j]);
+        i = j;
+    }
+    --m_size;
+    return true;
+}
+
+void TdbVectorMapBatch::clear() noexcept {
+    m_slots.clear();
+    m_size = 0u;
+    m_bytes = 0u;
+}
+
+void TdbVectorMapBatch::updateBytes(boost::string_view const key) noexcept {
+    Slot * const slot = findSlot(key, hashKey(key));
+    if (!slot)
+        return;
+    auto & entry = *slot->entry;
+    auto const bytes = boost::apply_visitor(BytesVisitor(), entry.vector);
+    m_bytes = m_bytes - entry.bytes + bytes;
+    entry.bytes = bytes;
+}
+
+std::uint64_t TdbVectorMapBatch::hashKey(boost::string_view const key)
+        noexcept
+{
+    // 64-bit FNV-1a:
+    std::uint64_t hash = 0xcbf29ce484222325u;
+    for (unsigned char const c : key) {
+        hash ^= c;
+        hash *= 0x100000001b3u;
+    }
+    return hash;
+}
+
+TdbVectorMapBatch::Slot * TdbVectorMapBatch::findSlot(
+        boost::string_view const key,
+        std::uint64_t const hash) noexcept
+{
+    if (m_slots.empty())
+        return nullptr;
+    auto const mask = m_slots.size() - 1u;
+    for (auto i = static_cast<std::size_t>(hash) & mask;
+         m_slots[i].entry;
+         i = (i + 1u) & mask)
+    {
+        auto & slot = m_slots[i];
+        if (slot.hash == hash && slot.entry->key == key)
+            return &slot;
+    }
+    return nullptr;
+}
+
+TdbVectorMapBatch::Entry * TdbVectorMapBatch::insertEntry(
+        std::uint64_t const hash,
+        std::unique_ptr<Entry> entry)
+{
+    // Keep the load factor at or below 1/2:
+    if ((m_size + 1u) * 2u > m_slots.size())
+        rehash(m_slots.empty() ? minCapacity : m_slots.size() * 2u);
+
+    auto const mask = m_slots.size() - 1u;
+    auto i = static_cast<std::size_t>(hash) & mask;
+    while (m_slots[i].entry)
+        i = (i + 1u) & mask;
+    entry->bytes = boost::apply_visitor(BytesVisitor(), entry->vector);
+    m_bytes += entryBytes(*entry);
+    m_slots[i].hash = hash;
+    m_slots[i].entry = std::move(entry);
+    ++m_size;
+    return m_slots[i].entry.get();
+}
+
+void TdbVectorMapBatch::rehash(std::size_t const newCapacity) {
+    assert(newCapacity && !(newCapacity & (newCapacity - 1u)));
+    assert(newCapacity > m_size);
+    std::vector<Slot> newSlots(newCapacity);
+    auto const mask = newCapacity - 1u;
+    for (auto & slot : m_slots) {
+        if (!slot.entry)
+            continue;
+        auto i = static_cast<std::size_t>(slot.hash) & mask;
+        while (newSlots[i].entry)
+            i = (i + 1u) & mask;
+        newSlots[i] = std::move(slot);
+    }
+    m_slots = std::move(newSlots);
+}
+
+} /* namespace sharemind { */
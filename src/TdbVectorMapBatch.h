@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SHAREMIND_MOD_TABLEDB_TDBVECTORMAPBATCH_H
+#define SHAREMIND_MOD_TABLEDB_TDBVECTORMAPBATCH_H
+
+#include <boost/utility/string_view.hpp>
+#include <boost/variant/variant.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "TdbVectorStorage.h"
+#include "tdbtypes.h"
+
+
+namespace sharemind {
+
+/**
+  \brief A single batch of a TdbVectorMap.
+
+  Maps vector names to vectors of one of the four element kinds. The table uses
+  open addressing with linear probing and backward shift deletion. Every slot
+  caches the hash of its key so that probing only compares the key string on a
+  hash match. Entries are allocated separately, hence references to vectors
+  stay valid when other vectors are added or removed. Lookups take string views
+  and do not allocate.
+*/
+class __attribute__ ((visibility("internal"))) TdbVectorMapBatch {
+
+public: /* Types: */
+
+    using VectorVariant =
+            boost::variant<TdbVectorStorage<SharemindTdbIndex>,
+                           TdbVectorStorage<SharemindTdbString>,
+                           TdbVectorStorage<SharemindTdbType>,
+                           TdbVectorStorage<SharemindTdbValue> >;
+
+private: /* Types: */
+
+    struct Entry {
+
+        template <typename ... Args>
+        Entry(std::string k, Args && ... args)
+            : key(std::move(k))
+            , vector(std::forward<Args>(args)...)
+        {}
+
+        std::string const key;
+        VectorVariant vector;
+
+        /* The memory held by the vector when last accounted: */
+        std::uint64_t bytes = 0u;
+
+    };
+
+    struct Slot {
+        std::uint64_t hash;
+        std::unique_ptr<Entry> entry;
+    };
+
+public: /* Methods: */
+
+    TdbVectorMapBatch() = default;
+    TdbVectorMapBatch(TdbVectorMapBatch &&) = default;
+    TdbVectorMapBatch & operator=(TdbVectorMapBatch &&) = default;
+
+    std::size_t size() const noexcept { return m_size; }
+    bool empty() const noexcept { return !m_size; }
+
+    VectorVariant * find(boost::string_view key) noexcept;
+    VectorVariant const * find(boost::string_view key) const noexcept;
+
+    /**
+      \brief Inserts a new empty vector of type V under the given key.
+      \returns a pointer to the vector with the given key and whether it was
+               inserted. The existing vector may be of another type.
+    */
+    template <typename V>
+    std::pair<VectorVariant *, bool> emplace(boost::string_view const key) {
+        auto const hash = hashKey(key);
+        if (Slot * const slot = findSlot(key, hash))
+            return {&slot->entry->vector, false};
+        std::unique_ptr<Entry> entry(
+                    new Entry(key.to_string(), TdbVectorStorage<V>()));
+        return {&insertEntry(hash, std::move(entry))->vector, true};
+    }
+
+    bool erase(boost::string_view key) noexcept;
+
+    /** \brief Calls f(key, vector) for every vector in unspecified order. */
+    template <typename F>
+    void forEach(F && f) const {
+        for (auto const & slot : m_slots)
+            if (slot.entry)
+                f(slot.entry->key,
+                  static_cast<VectorVariant const &>(slot.entry->vector));
+    }
+
+    void clear() noexcept;
+
+    /**
+      \brief Accounts the memory held by the vector with the given key, which
+             has to be called after modifying the vector.
+    */
+    void updateBytes(boost::string_view key) noexcept;
+
+    /**
+      \returns the memory held by this batch and its vectors, as accounted on
+               insertion and by updateBytes().
+    */
+    std::uint64_t bytes() const noexcept
+    { return m_slots.capacity() * sizeof(Slot) + m_bytes; }
+
+private: /* Methods: */
+
+    static std::uint64_t hashKey(boost::string_view key) noexcept;
+
+    Slot * findSlot(boost::string_view key, std::uint64_t hash) noexcept;
+
+    Entry * insertEntry(std::uint64_t hash, std::unique_ptr<Entry> entry);
+
+    static std::uint64_t entryBytes(Entry const & entry) noexcept
+    { return sizeof(Entry) + entry.key.size() + entry.bytes; }
+
+    void rehash(std::size_t newCapacity);
+
+private: /* Fields: */
+
+    std::vector<Slot> m_slots;
+    std::size_t m_size = 0u;
+
+    /* The memory held by the entries and their vectors: */
+    std::uint64_t m_bytes = 0u;
+
+}; /* class TdbVectorMapBatch { */
+
+} /* namespace sharemind { */
+
+#endif /* SHAREMIND_MOD_TABLEDB_TDBVECTORMAPBATCH_H */
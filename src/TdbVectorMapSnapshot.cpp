@@ -0,0 +1,534 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "TdbVectorMapSnapshot.h"
+
+#include <boost/utility/string_view.hpp>
+#include <boost/variant/apply_visitor.hpp>
+#include <boost/variant/static_visitor.hpp>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include "TdbVectorMap.h"
+
+
+namespace sharemind {
+
+namespace {
+
+using Exception = TdbVectorMap::Exception;
+using TypeIndex = TdbVectorStorage<SharemindTdbValue>::TypeIndex;
+
+/* The element kinds, in the order of TdbVectorMapBatch::VectorVariant: */
+enum Kind : std::uint8_t { IndexKind, StringKind, TypeKind, ValueKind };
+
+constexpr char const magic[7u] = {'T', 'D', 'B', 'V', 'M', 'A', 'P'};
+constexpr std::uint8_t const version = 1u;
+
+/* The smallest encodings of a vector and of a type: */
+constexpr std::uint64_t const minVectorSize = 1u + 2u * sizeof(std::uint64_t);
+constexpr std::uint64_t const minTypeSize = 3u * sizeof(std::uint64_t);
+
+[[noreturn]] void throwSystemError(char const * const what,
+                                   std::string const & path)
+{
+    throw Exception(std::string(what) + " \"" + path + "\": "
+                    + std::strerror(errno));
+}
+
+[[noreturn]] void throwInvalid(char const * const what) {
+    throw Exception(std::string("Invalid vector map snapshot: ") + what);
+}
+
+/** \brief Closes a file descriptor on destruction. */
+class FileDescriptor {
+
+public: /* Methods: */
+
+    explicit FileDescriptor(int const fd) noexcept : m_fd(fd) {}
+
+    FileDescriptor(FileDescriptor const &) = delete;
+    FileDescriptor & operator=(FileDescriptor const &) = delete;
+
+    ~FileDescriptor() noexcept {
+        if (m_fd >= 0)
+            ::close(m_fd);
+    }
+
+    int get() const noexcept { return m_fd; }
+
+private: /* Fields: */
+
+    int const m_fd;
+
+};
+
+/** \brief Maps a file into memory, which is unmapped on destruction. */
+class Mapping {
+
+public: /* Methods: */
+
+    Mapping(int const fd,
+            std::uint64_t const size,
+            int const protection,
+            int const flags) noexcept
+        : m_size(size)
+    {
+        void * const p = ::mmap(nullptr, size, protection, flags, fd, 0);
+        m_data = (p != MAP_FAILED) ? static_cast<unsigned char *>(p) : nullptr;
+    }
+
+    Mapping(Mapping const &) = delete;
+    Mapping & operator=(Mapping const &) = delete;
+
+    ~Mapping() noexcept {
+        if (m_data)
+            ::munmap(m_data, m_size);
+    }
+
+    /** \returns the mapped memory or nullptr if mapping failed. */
+    unsigned char * data() const noexcept { return m_data; }
+
+private: /* Fields: */
+
+    unsigned char * m_data;
+    std::uint64_t const m_size;
+
+};
+
+/** \brief Counts the size of a snapshot. */
+class SizeSink {
+
+public: /* Methods: */
+
+    void write(void const *, std::uint64_t const size) noexcept
+    { m_size += size; }
+
+    void align() noexcept { m_size = (m_size + 7u) & ~std::uint64_t(7u); }
+
+    std::uint64_t size() const noexcept { return m_size; }
+
+private: /* Fields: */
+
+    std::uint64_t m_size = 0u;
+
+};
+
+/** \brief Writes a snapshot to a buffer of the size counted by SizeSink. */
+class BufferSink {
+
+public: /* Methods: */
+
+    explicit BufferSink(unsigned char * const data) noexcept
+        : m_begin(data)
+        , m_pos(data)
+    {}
+
+    void write(void const * const data, std::uint64_t const size) noexcept {
+        if (size)
+            std::memcpy(m_pos, data, size);
+        m_pos += size;
+    }
+
+    void align() noexcept {
+        while ((m_pos - m_begin) % 8u)
+            *m_pos++ = 0u;
+    }
+
+    std::uint64_t size() const noexcept
+    { return static_cast<std::uint64_t>(m_pos - m_begin); }
+
+private: /* Fields: */
+
+    unsigned char * const m_begin;
+    unsigned char * m_pos;
+
+};
+
+template <typename Sink>
+void writeU64(Sink & sink, std::uint64_t const value)
+{ sink.write(&value, sizeof(value)); }
+
+template <typename Sink>
+void writeString(Sink & sink, char const * const str) {
+    if (!str) {
+        writeU64(sink, 0u);
+        return;
+    }
+    auto const size = std::strlen(str) + 1u;
+    writeU64(sink, size);
+    sink.write(str, size);
+}
+
+template <typename Sink>
+void writeType(Sink & sink, SharemindTdbType const & type) {
+    writeString(sink, type.domain);
+    writeString(sink, type.name);
+    writeU64(sink, type.size);
+}
+
+template <typename Sink>
+class WriteVisitor: public boost::static_visitor<> {
+
+public: /* Methods: */
+
+    explicit WriteVisitor(Sink & sink) noexcept : m_sink(sink) {}
+
+    void operator()(TdbVectorStorage<SharemindTdbIndex> const & vec) const {
+        writeU64(m_sink, vec.size());
+        m_sink.align();
+        m_sink.write(vec.data(), vec.size() * sizeof(std::uint64_t));
+    }
+
+    void operator()(TdbVectorStorage<SharemindTdbString> const & vec) const {
+        writeU64(m_sink, vec.size());
+        auto const chars = vec.offsets()[vec.size()];
+        writeU64(m_sink, chars);
+        m_sink.write(vec.data(), chars);
+    }
+
+    void operator()(TdbVectorStorage<SharemindTdbType> const & vec) const {
+        writeU64(m_sink, vec.size());
+        for (std::size_t i = 0u; i < vec.size(); ++i)
+            writeType(m_sink, vec.at(i));
+    }
+
+    void operator()(TdbVectorStorage<SharemindTdbValue> const & vec) const {
+        auto const n = vec.size();
+        writeU64(m_sink, n);
+        writeU64(m_sink, vec.typeCount());
+        for (std::size_t i = 0u; i < vec.typeCount(); ++i)
+            writeType(m_sink, vec.type(static_cast<TypeIndex>(i)));
+        m_sink.write(vec.typeIndexes(), n * sizeof(TypeIndex));
+        auto const * const offsets = vec.offsets();
+        for (std::size_t i = 0u; i < n; ++i)
+            writeU64(m_sink, offsets[i + 1u] - offsets[i]);
+        writeU64(m_sink, offsets[n] - offsets[0u]);
+        m_sink.write(vec.payload() + offsets[0u], offsets[n] - offsets[0u]);
+    }
+
+private: /* Fields: */
+
+    Sink & m_sink;
+
+};
+
+template <typename Sink>
+void writeMap(TdbVectorMap const & map, Sink & sink) {
+    sink.write(magic, sizeof(magic));
+    sink.write(&version, sizeof(version));
+    writeU64(sink, map.batchCount());
+    writeU64(sink, map.currentBatchNumber());
+    for (std::size_t b = 0u; b < map.batchCount(); ++b) {
+        auto const & batch = map.batch(b);
+        writeU64(sink, batch.size());
+        batch.forEach(
+                [&sink](std::string const & key,
+                        TdbVectorMapBatch::VectorVariant const & v)
+                {
+                    auto const kind = static_cast<std::uint8_t>(v.which());
+                    sink.write(&kind, sizeof(kind));
+                    writeU64(sink, key.size());
+                    sink.write(key.data(), key.size());
+                    boost::apply_visitor(WriteVisitor<Sink>(sink), v);
+                });
+    }
+}
+
+/** \brief Reads a snapshot, checking every read against the end of it. */
+class Reader {
+
+public: /* Methods: */
+
+    Reader(unsigned char const * const data, std::uint64_t const size) noexcept
+        : m_begin(data)
+        , m_pos(data)
+        , m_end(data + size)
+    {}
+
+    bool atEnd() const noexcept { return m_pos == m_end; }
+
+    unsigned char const * take(std::uint64_t const size) {
+        if (size > remaining())
+            throwInvalid("unexpected end of file.");
+        auto const * const r = m_pos;
+        m_pos += size;
+        return r;
+    }
+
+    /** \brief Checks that n encodings of at least the given size may follow. */
+    void checkCount(std::uint64_t const n, std::uint64_t const minSize) const {
+        if (n > remaining() / minSize)
+            throwInvalid("unexpected end of file.");
+    }
+
+    unsigned char const * takeArray(std::uint64_t const n,
+                                    std::uint64_t const elemSize)
+    {
+        checkCount(n, elemSize);
+        return take(n * elemSize);
+    }
+
+    void align()
+    { take((8u - static_cast<std::uint64_t>(m_pos - m_begin) % 8u) % 8u); }
+
+    std::uint8_t readU8() { return *take(1u); }
+
+    std::uint64_t readU64() {
+        std::uint64_t r;
+        std::memcpy(&r, take(sizeof(r)), sizeof(r));
+        return r;
+    }
+
+    /** \returns a pointer to the NUL-terminated string or nullptr. */
+    char * readString() {
+        auto const size = readU64();
+        if (!size)
+            return nullptr;
+        auto * const str =
+                const_cast<char *>(reinterpret_cast<char const *>(take(size)));
+        if (str[size - 1u] != '\0')
+            throwInvalid("string is not NUL-terminated.");
+        return str;
+    }
+
+    SharemindTdbType readType() {
+        auto * const domain = readString();
+        auto * const name = readString();
+        return SharemindTdbType{domain, name, readU64()};
+    }
+
+private: /* Methods: */
+
+    std::uint64_t remaining() const noexcept
+    { return static_cast<std::uint64_t>(m_end - m_pos); }
+
+private: /* Fields: */
+
+    unsigned char const * const m_begin;
+    unsigned char const * m_pos;
+    unsigned char const * const m_end;
+
+};
+
+template <typename T>
+T readArrayElement(unsigned char const * const array, std::uint64_t const i)
+        noexcept
+{
+    T r;
+    std::memcpy(&r, array + i * sizeof(T), sizeof(T));
+    return r;
+}
+
+/** \brief Loads a vector into the current batch of the map. */
+void loadVector(Reader & reader, TdbVectorMap & map) {
+    auto const kind = reader.readU8();
+    auto const keySize = reader.readU64();
+    boost::string_view const key(
+                reinterpret_cast<char const *>(reader.take(keySize)),
+                keySize);
+    if (map.count(key))
+        throwInvalid("duplicate vector name.");
+    auto const n = reader.readU64();
+
+    switch (kind) {
+    case IndexKind: {
+        reader.align();
+        auto const * const data = reader.takeArray(n, sizeof(std::uint64_t));
+        auto const bytes = map.appendBytes<SharemindTdbIndex>(
+                    key, n, n * sizeof(std::uint64_t));
+        map.checkQuota(bytes);
+        map.getOrCreateVector<SharemindTdbIndex>(key).append(
+                    reinterpret_cast<std::uint64_t const *>(data),
+                    n);
+        break;
+    }
+    case StringKind: {
+        auto const chars = reader.readU64();
+        if (n > chars)
+            throwInvalid("string vector is too short.");
+        auto const * p = reinterpret_cast<char const *>(reader.take(chars));
+        auto const * const end = p + chars;
+        auto const bytes = map.appendBytes<SharemindTdbString>(key, n, chars);
+        map.checkQuota(bytes);
+        auto & vec = map.getOrCreateVector<SharemindTdbString>(key);
+        for (std::uint64_t i = 0u; i < n; ++i) {
+            auto const * const e =
+                    static_cast<char const *>(
+                        std::memchr(p, '\0', static_cast<std::size_t>(end - p)));
+            if (!e)
+                throwInvalid("string is not NUL-terminated.");
+            vec.push_back(p, static_cast<std::size_t>(e - p));
+            p = e + 1u;
+        }
+        if (p != end)
+            throwInvalid("string vector is too long.");
+        break;
+    }
+    case TypeKind: {
+        reader.checkCount(n, minTypeSize);
+        auto const bytes =
+                map.appendBytes<SharemindTdbType>(key, n, n * minTypeSize);
+        map.checkQuota(bytes);
+        auto & vec = map.getOrCreateVector<SharemindTdbType>(key);
+        for (std::uint64_t i = 0u; i < n; ++i)
+            vec.push_back(reader.readType());
+        break;
+    }
+    case ValueKind: {
+        auto const typeCount = reader.readU64();
+        reader.checkCount(typeCount, minTypeSize);
+        std::vector<SharemindTdbType> types;
+        types.reserve(typeCount);
+        for (std::uint64_t i = 0u; i < typeCount; ++i)
+            types.push_back(reader.readType());
+        auto const * const indexes = reader.takeArray(n, sizeof(TypeIndex));
+        auto const * const sizes = reader.takeArray(n, sizeof(std::uint64_t));
+        auto const payloadSize = reader.readU64();
+        auto const * const payload = reader.take(payloadSize);
+
+        std::uint64_t total = 0u;
+        for (std::uint64_t i = 0u; i < n; ++i) {
+            auto const size = readArrayElement<std::uint64_t>(sizes, i);
+            if (readArrayElement<TypeIndex>(indexes, i) >= typeCount
+                || size > payloadSize - total)
+                throwInvalid("invalid value vector.");
+            total += size;
+        }
+        if (total != payloadSize)
+            throwInvalid("invalid value vector.");
+
+        auto const bytes =
+                map.appendBytes<SharemindTdbValue>(key, n, payloadSize);
+        map.checkQuota(bytes);
+        auto & vec = map.getOrCreateVector<SharemindTdbValue>(key);
+
+        // Consecutive values of the same type and size are appended at once:
+        std::uint64_t offset = 0u;
+        for (std::uint64_t i = 0u; i < n;) {
+            auto const type = readArrayElement<TypeIndex>(indexes, i);
+            auto const size = readArrayElement<std::uint64_t>(sizes, i);
+            auto j = i + 1u;
+            while (j < n
+                   && readArrayElement<TypeIndex>(indexes, j) == type
+                   && readArrayElement<std::uint64_t>(sizes, j) == size)
+                ++j;
+            vec.append(types[type], payload + offset, j - i, size);
+            offset += (j - i) * size;
+            i = j;
+        }
+        break;
+    }
+    default:
+        throwInvalid("unknown vector kind.");
+    }
+    map.updateUsage(key);
+}
+
+} // anonymous namespace
+
+void TdbVectorMapSnapshot::save(TdbVectorMap const & map,
+                                std::string const & path)
+{
+    SizeSink sizer;
+    writeMap(map, sizer);
+    auto const size = sizer.size();
+
+    // Write a temporary file next to the snapshot and rename it on success:
+    std::string tmpPath(path);
+    tmpPath += ".XXXXXX";
+    FileDescriptor const fd(::mkostemp(&tmpPath[0u], O_CLOEXEC));
+    if (fd.get() < 0)
+        throwSystemError("Failed to create vector map snapshot", path);
+    try {
+        if (int const e = ::posix_fallocate(fd.get(),
+                                            0,
+                                            static_cast<off_t>(size)))
+        {
+            errno = e;
+            throwSystemError("Failed to write vector map snapshot", path);
+        }
+        {
+            Mapping const mapping(fd.get(),
+                                  size,
+                                  PROT_READ | PROT_WRITE,
+                                  MAP_SHARED);
+            if (!mapping.data())
+                throwSystemError("Failed to map vector map snapshot", path);
+            BufferSink sink(mapping.data());
+            writeMap(map, sink);
+            assert(sink.size() == size);
+        }
+        if (::rename(tmpPath.c_str(), path.c_str()))
+            throwSystemError("Failed to write vector map snapshot", path);
+    } catch (...) {
+        ::unlink(tmpPath.c_str());
+        throw;
+    }
+}
+
+void TdbVectorMapSnapshot::load(std::string const & path, TdbVectorMap & map) {
+    assert(map.batchCount() == 1u);
+    assert(map.currentBatch().empty());
+
+    FileDescriptor const fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (fd.get() < 0)
+        throwSystemError("Failed to open vector map snapshot", path);
+    struct ::stat st;
+    if (::fstat(fd.get(), &st))
+        throwSystemError("Failed to open vector map snapshot", path);
+    auto const size = static_cast<std::uint64_t>(st.st_size);
+    if (size < sizeof(magic) + sizeof(version))
+        throwInvalid("unexpected end of file.");
+    Mapping const mapping(fd.get(), size, PROT_READ, MAP_PRIVATE);
+    if (!mapping.data())
+        throwSystemError("Failed to map vector map snapshot", path);
+    ::madvise(mapping.data(), size, MADV_SEQUENTIAL);
+
+    Reader reader(mapping.data(), size);
+    if (std::memcmp(reader.take(sizeof(magic)), magic, sizeof(magic))
+        || reader.readU8() != version)
+        throwInvalid("unknown format.");
+    auto const batchCount = reader.readU64();
+    auto const currentBatch = reader.readU64();
+    if (currentBatch >= batchCount)
+        throwInvalid("invalid batch number.");
+    reader.checkCount(batchCount, sizeof(std::uint64_t));
+
+    for (std::uint64_t b = 0u; b < batchCount; ++b) {
+        if (b)
+            map.addBatch();
+        auto const vectorCount = reader.readU64();
+        reader.checkCount(vectorCount, minVectorSize);
+        for (std::uint64_t i = 0u; i < vectorCount; ++i)
+            loadVector(reader, map);
+    }
+    if (!reader.atEnd())
+        throwInvalid("trailing data.");
+    map.setBatch(currentBatch);
+}
+
+} /* namespace sharemind { */
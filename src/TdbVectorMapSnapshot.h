@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SHAREMIND_MOD_TABLEDB_TDBVECTORMAPSNAPSHOT_H
+#define SHAREMIND_MOD_TABLEDB_TDBVECTORMAPSNAPSHOT_H
+
+#include <string>
+
+
+namespace sharemind {
+
+class TdbVectorMap;
+
+/**
+  \brief Binary snapshots of the contents of vector maps.
+
+  A snapshot holds all batches of a vector map with vectors of all four element
+  kinds, laid out so that it can be read back sequentially from a memory map.
+  All integers are 64-bit and in native byte order, except for the element kind
+  and the type indexes of value vectors:
+
+    snapshot: "TDBVMAP" version:u8 batchCount currentBatch batch*
+    batch:    vectorCount vector*
+    vector:   kind:u8 keySize key elementCount elements
+    index:    padding to 8 bytes, index*
+    string:   charCount chars (elementCount NUL-terminated strings)
+    type:     (domain name size)*
+    value:    typeCount (domain name size)* typeIndex:u32* valueSize*
+              payloadSize payload
+    domain, name: 0 for a null string, otherwise length+1 and a NUL-terminated
+                  string
+
+  Both functions throw TdbVectorMap::Exception on failure.
+*/
+class __attribute__ ((visibility("internal"))) TdbVectorMapSnapshot {
+
+public: /* Methods: */
+
+    /**
+      \brief Writes a snapshot of the vector map to the given file, replacing
+             it atomically.
+    */
+    static void save(TdbVectorMap const & map, std::string const & path);
+
+    /**
+      \brief Loads a snapshot from the given file into the vector map.
+      \pre The vector map is empty and has a single batch.
+      \throws TdbVectorMap::QuotaException if the memory quota of the process
+              would be exceeded.
+    */
+    static void load(std::string const & path, TdbVectorMap & map);
+
+}; /* class TdbVectorMapSnapshot { */
+
+} /* namespace sharemind { */
+
+#endif /* SHAREMIND_MOD_TABLEDB_TDBVECTORMAPSNAPSHOT_H */
@@ -19,7 +19,13 @@
 
 #include "TdbVectorMapUtil.h"
 
+#include <cassert>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
+#include "TdbMemoryAccount.h"
+#include "TdbValueArena.h"
 #include "TdbVectorMap.h"
 
 
@@ -89,6 +95,110 @@ SharemindTdbVectorMap * SharemindTdbVectorMapUtil_get_map(
 template <class T>
 void destroy(void * ptr) noexcept { delete static_cast<T *>(ptr); }
 
+/**
+  \brief Per-process allocator of vector map identifiers.
+
+  Stored in the vector map data store itself under a key which can not clash
+  with the decimal vector map identifiers. Identifiers of deleted maps are
+  reused before new ones are handed out.
+*/
+struct VectorMapIdAllocator {
+
+    static constexpr char const * const key = "IdAllocator";
+
+    uint64_t allocate() {
+        if (freeIds.empty())
+            return nextId++;
+        auto const id = freeIds.back();
+        freeIds.pop_back();
+        return id;
+    }
+
+    void release(uint64_t const id) {
+        assert(id && id < nextId);
+        freeIds.push_back(id);
+    }
+
+    uint64_t nextId = 1u;
+    std::vector<uint64_t> freeIds;
+
+};
+
+constexpr char const * const VectorMapIdAllocator::key;
+
+/**
+  \brief The memory account of the vector maps in a data store, shared with
+         the maps so that it outlives them regardless of destruction order.
+*/
+struct VectorMapAccount {
+
+    static constexpr char const * const key = "MemoryAccount";
+
+    std::shared_ptr<sharemind::TdbMemoryAccount> account;
+
+};
+
+constexpr char const * const VectorMapAccount::key;
+
+VectorMapIdAllocator * getIdAllocator(SharemindDataStore * dataStore,
+                                      bool const create)
+{
+    using A = VectorMapIdAllocator;
+    if (auto * const a = static_cast<A *>(dataStore->get(dataStore, A::key)))
+        return a;
+    if (!create)
+        return nullptr;
+
+    auto * const a = new A;
+    if (dataStore->set(dataStore, A::key, a, &destroy<A>))
+        return a;
+
+    delete a;
+    return nullptr;
+}
+
+std::shared_ptr<sharemind::TdbMemoryAccount> getAccount(
+        SharemindDataStore * dataStore,
+        std::uint64_t const quota)
+{
+    using A = VectorMapAccount;
+    if (auto * const a = static_cast<A *>(dataStore->get(dataStore, A::key)))
+        return a->account;
+
+    auto * const a = new A{std::make_shared<sharemind::TdbMemoryAccount>(quota)};
+    if (dataStore->set(dataStore, A::key, a, &destroy<A>))
+        return a->account;
+
+    delete a;
+    return nullptr;
+}
+
+/**
+  \brief The data store key of a vector map, formatted without allocating.
+*/
+class VectorMapKey {
+
+public: /* Methods: */
+
+    explicit VectorMapKey(uint64_t id) noexcept {
+        char * p = m_buffer + sizeof(m_buffer) - 1u;
+        *p = '\0';
+        do {
+            *--p = static_cast<char>('0' + id % 10u);
+            id /= 10u;
+        } while (id);
+        m_str = p;
+    }
+
+    char const * c_str() const noexcept { return m_str; }
+
+private: /* Fields: */
+
+    char m_buffer[21u];
+    char const * m_str;
+
+};
+
 } // anonymous namespace
 
 namespace sharemind {
@@ -99,25 +209,48 @@ TdbVectorMapUtil::TdbVectorMapUtil()
                                   &SharemindTdbVectorMapUtil_get_map}
 {}
 
+void TdbVectorMapUtil::setSpillPolicy(std::string directory,
+                                      std::uint64_t const threshold)
+{
+    if (threshold) {
+        m_spillPolicy = std::make_shared<TdbSpillPolicy const>(
+                            TdbSpillPolicy{std::move(directory), threshold});
+    } else {
+        m_spillPolicy.reset();
+    }
+}
+
 TdbVectorMap * TdbVectorMapUtil::newVectorMap(SharemindDataStore * dataStore)
         const
 {
     assert(dataStore);
 
-    uint64_t vmapId = 0;
-    std::string s;
+    VectorMapIdAllocator * const ids = getIdAllocator(dataStore, true);
+    if (!ids)
+        return nullptr;
+    auto account(getAccount(dataStore, m_memoryQuota));
+    if (!account)
+        return nullptr;
 
-    // Generate an unique identifier:
-    do {
-        s = std::to_string(++vmapId);
-    } while (!!dataStore->get(dataStore, s.c_str()));
+    // Get an unique identifier:
+    uint64_t const vmapId = ids->allocate();
+    try {
+        VectorMapKey const s(vmapId);
+        assert(!dataStore->get(dataStore, s.c_str()));
 
-    // Store the map:
-    TdbVectorMap * const map = new TdbVectorMap{vmapId};
-    if (dataStore->set(dataStore, s.c_str(), map, &destroy<TdbVectorMap>))
-        return map;
+        // Store the map:
+        TdbVectorMap * const map = new TdbVectorMap{vmapId,
+                                                    std::move(account),
+                                                    m_spillPolicy};
+        if (dataStore->set(dataStore, s.c_str(), map, &destroy<TdbVectorMap>))
+            return map;
 
-    delete map;
+        delete map;
+    } catch (...) {
+        ids->release(vmapId);
+        throw;
+    }
+    ids->release(vmapId);
     return nullptr;
 }
 
@@ -125,7 +258,29 @@ bool TdbVectorMapUtil::deleteVectorMap(SharemindDataStore * dataStore,
                                        const uint64_t vmapId) const noexcept
 {
     assert(dataStore);
-    return dataStore->remove(dataStore, std::to_string(vmapId).c_str());
+    try {
+        if (!dataStore->remove(dataStore, VectorMapKey(vmapId).c_str()))
+            return false;
+    } catch (...) {
+        return false;
+    }
+
+    // Failing to recycle the identifier is harmless, it just won't be reused:
+    try {
+        if (VectorMapIdAllocator * const ids =
+                getIdAllocator(dataStore, false))
+            ids->release(vmapId);
+    } catch (...) {}
+    return true;
+}
+
+std::shared_ptr<TdbMemoryAccount> TdbVectorMapUtil::memoryAccount(
+        SharemindDataStore * dataStore) const noexcept
+{
+    assert(dataStore);
+    auto const * const a = static_cast<VectorMapAccount *>(
+                dataStore->get(dataStore, VectorMapAccount::key));
+    return a ? a->account : nullptr;
 }
 
 TdbVectorMap * TdbVectorMapUtil::getVectorMap(
@@ -134,7 +289,7 @@ TdbVectorMap * TdbVectorMapUtil::getVectorMap(
 {
     assert(dataStore);
     return static_cast<TdbVectorMap *>(
-                dataStore->get(dataStore, std::to_string(vmapId).c_str()));
+                dataStore->get(dataStore, VectorMapKey(vmapId).c_str()));
 }
 
 } /* namespace sharemind { */
@@ -20,12 +20,17 @@
 #ifndef SHAREMIND_MOD_TABLEDB_TDBVECTORMAPUTIL_H
 #define SHAREMIND_MOD_TABLEDB_TDBVECTORMAPUTIL_H
 
+#include <cstdint>
+#include <memory>
+#include <string>
 #include "tdbvectormapapi.h"
 
 
 namespace sharemind {
 
+class TdbMemoryAccount;
 class TdbVectorMap;
+struct TdbSpillPolicy;
 
 class __attribute__ ((visibility("internal"))) TdbVectorMapUtil
     : private ::SharemindTdbVectorMapUtil
@@ -35,6 +40,28 @@ public: /* Methods: */
 
     TdbVectorMapUtil();
 
+    /**
+      \brief Sets the limit of the memory held by the vector maps of a process,
+             or 0 for no limit. Only affects processes creating their first
+             vector map afterwards.
+    */
+    void setMemoryQuota(std::uint64_t const quota) noexcept
+    { m_memoryQuota = quota; }
+
+    /**
+      \brief Makes the value vectors of vector maps created afterwards spill
+             their payloads into files in the given directory once they grow
+             beyond the given number of bytes, or never if 0.
+    */
+    void setSpillPolicy(std::string directory, std::uint64_t threshold);
+
+    /**
+      \returns the memory account of the vector maps in the data store or
+               nullptr if no vector maps have been created in it.
+    */
+    std::shared_ptr<TdbMemoryAccount> memoryAccount(
+            SharemindDataStore * dataStore) const noexcept;
+
     TdbVectorMap * newVectorMap(SharemindDataStore * dataStore) const;
 
     bool deleteVectorMap(SharemindDataStore * dataStore,
@@ -51,6 +78,11 @@ public: /* Methods: */
 
     inline const SharemindTdbVectorMapUtil * getWrapper() const { return this; }
 
+private: /* Fields: */
+
+    std::uint64_t m_memoryQuota = 0u;
+    std::shared_ptr<TdbSpillPolicy const> m_spillPolicy;
+
 }; /* class TdbVectorMapUtil { */
 
 } /* namespace sharemind { */
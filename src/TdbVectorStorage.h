@@ -0,0 +1,945 @@
+/*
+ * Copyright (C) 2015 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SHAREMIND_MOD_TABLEDB_TDBVECTORSTORAGE_H
+#define SHAREMIND_MOD_TABLEDB_TDBVECTORSTORAGE_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <boost/checked_delete.hpp>
+#include <boost/ptr_container/clone_allocator.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+
+#include "TdbValueArena.h"
+#include "tdbtypes.h"
+
+
+namespace sharemind {
+
+// We want a custom clone allocator and deleter for some of the types, however
+// we don't want to propagate the new_clone and delete_clone functions to all
+// the other ptr_containers used elsewhere.
+struct tdb_heap_clone_allocator {
+public: /* Methods: */
+
+    template<class U>
+    static U * allocate_clone(const U & r) {
+        return new_clone(r);
+    }
+
+    template<class U>
+    static void deallocate_clone(const U * r) {
+        delete_clone(r);
+    }
+
+private: /* Methods: */
+
+    template<class T>
+    static inline T * new_clone(const T & r) {
+        return boost::new_clone(r);
+    }
+
+    template<class T>
+    static inline T * new_clone(const T * r) {
+        return boost::new_clone(r);
+    }
+
+    template<class T>
+    static inline void delete_clone(const T * r) {
+        boost::delete_clone(r);
+    }
+
+    static inline SharemindTdbString * new_clone(const SharemindTdbString & r) {
+        SharemindTdbString * res = new SharemindTdbString;
+
+        const size_t len = strlen(r.str);
+        res->str = new char[len + 1];
+        strncpy(res->str, r.str, len + 1);
+
+        return res;
+    }
+
+    static inline void delete_clone(const SharemindTdbString * r) {
+        delete[] r->str;
+        boost::checked_delete(r);
+    }
+
+    static inline SharemindTdbType * new_clone(const SharemindTdbType & r) {
+        SharemindTdbType * res = new SharemindTdbType(r);
+
+        if (r.domain) {
+            size_t len = strlen(r.domain);
+            res->domain = new char[len + 1];
+            strncpy(res->domain, r.domain, len + 1);
+        }
+        if (r.name) {
+            size_t len = strlen(r.name);
+            res->name = new char[len + 1];
+            strncpy(res->name, r.name, len + 1);
+        }
+
+        return res;
+    }
+
+    static inline void delete_clone(const SharemindTdbType * r) {
+        delete[] r->domain;
+        delete[] r->name;
+        boost::checked_delete(r);
+    }
+
+    static inline SharemindTdbValue * new_clone(const SharemindTdbValue & r) {
+        SharemindTdbValue * res = new SharemindTdbValue;
+
+        res->type = new_clone(*r.type);
+        res->buffer = ::operator new(r.size);
+        memcpy(res->buffer, r.buffer, r.size);
+        res->size = r.size;
+
+        return res;
+    }
+
+    static inline void delete_clone(const SharemindTdbValue * r) {
+        ::operator delete(r->buffer);
+        delete_clone(r->type);
+        boost::checked_delete(r);
+    }
+
+};
+
+/**
+  \brief Storage for a single vector of a TdbVectorMap batch.
+
+  Every element kind has a specialization below that keeps the elements in
+  contiguous columnar storage, hence releasing a vector takes a constant number
+  of deallocations regardless of its length. All specializations provide the
+  same interface so that TdbVectorMap can handle them uniformly. Elements not
+  stored as such are returned by value as views into the storage. The arrays
+  returned by getCArray() are compatibility views for the C API in
+  tdbvectormapapi.h and remain valid only until the vector is modified.
+  setCArray() copies the given elements and frees them along with the array.
+  bytes() returns the memory held by the vector, including unused capacity.
+*/
+template <typename V>
+class TdbVectorStorage;
+
+/**
+  \brief Index vectors are stored as a flat array of 64-bit indexes.
+*/
+template <>
+class __attribute__ ((visibility("internal")))
+        TdbVectorStorage<SharemindTdbIndex>
+{
+
+private: /* Types: */
+
+    using Container = std::vector<SharemindTdbIndex>;
+
+public: /* Types: */
+
+    using size_type = Container::size_type;
+    using reference = Container::reference;
+    using const_reference = Container::const_reference;
+
+    /* Memory held for every element in addition to its payload: */
+    static constexpr std::uint64_t elementBytes = 0u;
+
+public: /* Methods: */
+
+    size_type size() const noexcept { return m_data.size(); }
+
+    reference at(size_type const n) { return m_data.at(n); }
+    const_reference at(size_type const n) const { return m_data.at(n); }
+
+    void push_back(SharemindTdbIndex const & val) { m_data.push_back(val); }
+
+    void append(uint64_t const * data, size_type const n) {
+        static_assert(sizeof(SharemindTdbIndex) == sizeof(uint64_t), "");
+        auto const oldSize = m_data.size();
+        m_data.resize(oldSize + n);
+        if (n)
+            std::memcpy(&m_data[oldSize], data, n * sizeof(uint64_t));
+    }
+
+    /** \brief Takes ownership of val on success. */
+    void push_back(SharemindTdbIndex * val) {
+        assert(val);
+        m_data.push_back(*val);
+        boost::checked_delete(val);
+    }
+
+    void pop_back() {
+        if (m_data.empty())
+            throw std::out_of_range("pop_back() on empty vector");
+        m_data.pop_back();
+    }
+
+    void clear() noexcept { m_data.clear(); }
+
+    uint64_t const * data() const noexcept {
+        static_assert(sizeof(SharemindTdbIndex) == sizeof(uint64_t), "");
+        return reinterpret_cast<uint64_t const *>(m_data.data());
+    }
+
+    std::uint64_t bytes() const noexcept {
+        return m_data.capacity() * sizeof(SharemindTdbIndex)
+               + m_view.capacity() * sizeof(SharemindTdbIndex *);
+    }
+
+    void getCArray(SharemindTdbIndex **& array, size_type & size) {
+        m_view.resize(m_data.size());
+        for (size_type i = 0u; i < m_data.size(); ++i)
+            m_view[i] = &m_data[i];
+        array = m_view.empty() ? nullptr : m_view.data();
+        size = m_data.size();
+    }
+
+    /** \brief Takes ownership of the elements and the array on success. */
+    void setCArray(SharemindTdbIndex ** array, size_type const size) {
+        m_data.reserve(m_data.size() + size);
+        for (size_type i = 0u; i < size; ++i) {
+            assert(array[i]);
+            m_data.push_back(*array[i]);
+            boost::checked_delete(array[i]);
+        }
+        delete[] array;
+    }
+
+private: /* Fields: */
+
+    Container m_data;
+    std::vector<SharemindTdbIndex *> m_view;
+
+}; /* class TdbVectorStorage<SharemindTdbIndex> { */
+
+/**
+  \brief String vectors keep all NUL-terminated strings back to back in a
+         single character arena indexed by an offsets array.
+*/
+template <>
+class __attribute__ ((visibility("internal")))
+        TdbVectorStorage<SharemindTdbString>
+{
+
+public: /* Types: */
+
+    using size_type = std::vector<uint64_t>::size_type;
+
+    /* Memory held for every element in addition to its payload: */
+    static constexpr std::uint64_t elementBytes = sizeof(uint64_t);
+
+    /* Elements are returned as views into the arena: */
+    using reference = SharemindTdbString;
+    using const_reference = SharemindTdbString;
+
+public: /* Methods: */
+
+    size_type size() const noexcept { return m_offsets.size() - 1u; }
+
+    reference at(size_type const n) const {
+        if (n >= size())
+            throw std::out_of_range("string vector index out of range");
+        return SharemindTdbString{
+                    const_cast<char *>(m_chars.data()) + m_offsets[n]};
+    }
+
+    /** \brief Appends the string up to its first NUL or size characters. */
+    void push_back(char const * const str, size_type const size) {
+        assert(str || !size);
+        auto const * const end = size
+                ? static_cast<char const *>(std::memchr(str, '\0', size))
+                : nullptr;
+        auto const length = end ? static_cast<size_type>(end - str) : size;
+        auto const oldCharsSize = m_chars.size();
+        if (m_offsets.size() == m_offsets.capacity())
+            m_offsets.reserve(m_offsets.size() * 2u);
+        m_chars.resize(oldCharsSize + length + 1u);
+        if (length)
+            std::memcpy(&m_chars[oldCharsSize], str, length);
+        m_chars.back() = '\0';
+        m_offsets.push_back(m_chars.size());
+    }
+
+    /** \brief Takes ownership of val on success. */
+    void push_back(SharemindTdbString * val) {
+        assert(val);
+        assert(val->str);
+        push_back(val->str, std::strlen(val->str));
+        tdb_heap_clone_allocator::deallocate_clone(val);
+    }
+
+    void pop_back() {
+        if (!size())
+            throw std::out_of_range("pop_back() on empty vector");
+        m_offsets.pop_back();
+        m_chars.resize(m_offsets.back());
+    }
+
+    void clear() noexcept {
+        m_offsets.resize(1u);
+        m_chars.clear();
+    }
+
+    /**
+      \returns the offsets array of size()+1 elements. String i including its
+               terminating NUL is at data() + offsets()[i] and ends at
+               data() + offsets()[i + 1].
+    */
+    uint64_t const * offsets() const noexcept { return m_offsets.data(); }
+
+    char const * data() const noexcept { return m_chars.data(); }
+
+    std::uint64_t bytes() const noexcept {
+        return m_chars.capacity()
+               + m_offsets.capacity() * sizeof(uint64_t)
+               + m_viewValues.capacity() * sizeof(SharemindTdbString)
+               + m_view.capacity() * sizeof(SharemindTdbString *);
+    }
+
+    void getCArray(SharemindTdbString **& array, size_type & size_) {
+        auto const n = size();
+        m_viewValues.resize(n);
+        m_view.resize(n);
+        for (size_type i = 0u; i < n; ++i) {
+            m_viewValues[i].str = m_chars.data() + m_offsets[i];
+            m_view[i] = &m_viewValues[i];
+        }
+        array = m_view.empty() ? nullptr : m_view.data();
+        size_ = n;
+    }
+
+    /** \brief Takes ownership of the elements and the array on success. */
+    void setCArray(SharemindTdbString ** array, size_type const size_) {
+        uint64_t chars = 0u;
+        for (size_type i = 0u; i < size_; ++i) {
+            assert(array[i]);
+            assert(array[i]->str);
+            chars += std::strlen(array[i]->str) + 1u;
+        }
+        m_chars.reserve(m_chars.size() + chars);
+        m_offsets.reserve(m_offsets.size() + size_);
+
+        // Nothing below throws, since the space has been reserved:
+        for (size_type i = 0u; i < size_; ++i) {
+            auto const * const str = array[i]->str;
+            m_chars.insert(m_chars.end(), str, str + std::strlen(str) + 1u);
+            m_offsets.push_back(m_chars.size());
+            tdb_heap_clone_allocator::deallocate_clone(array[i]);
+        }
+        delete[] array;
+    }
+
+private: /* Fields: */
+
+    std::vector<char> m_chars;
+    std::vector<uint64_t> m_offsets{0u};
+    std::vector<SharemindTdbString> m_viewValues;
+    std::vector<SharemindTdbString *> m_view;
+
+}; /* class TdbVectorStorage<SharemindTdbString> { */
+
+/**
+  \brief Type vectors keep the domain and name strings of all types in a single
+         character arena.
+*/
+template <>
+class __attribute__ ((visibility("internal")))
+        TdbVectorStorage<SharemindTdbType>
+{
+
+private: /* Types: */
+
+    /* Offsets of the strings in the arena, noString for null strings: */
+    struct Entry {
+        uint64_t domain;
+        uint64_t name;
+        uint64_t size;
+    };
+
+    enum : uint64_t { noString = ~static_cast<uint64_t>(0u) };
+
+public: /* Types: */
+
+    using size_type = std::vector<Entry>::size_type;
+
+    /* Memory held for every element in addition to its payload: */
+    static constexpr std::uint64_t elementBytes = sizeof(Entry);
+
+    /* Elements are returned as views into the arena: */
+    using reference = SharemindTdbType;
+    using const_reference = SharemindTdbType;
+
+public: /* Methods: */
+
+    size_type size() const noexcept { return m_entries.size(); }
+
+    reference at(size_type const n) const {
+        if (n >= m_entries.size())
+            throw std::out_of_range("type vector index out of range");
+        return element(n);
+    }
+
+    /**
+      \brief Appends a type with the given domain and name, each taken up to
+             its first NUL or given size.
+    */
+    void push_back(char const * const domain,
+                   size_type const domainSize,
+                   char const * const name,
+                   size_type const nameSize,
+                   uint64_t const size_)
+    {
+        assert(domain || !domainSize);
+        assert(name || !nameSize);
+        if (m_entries.size() == m_entries.capacity())
+            m_entries.reserve(m_entries.size() * 2u + 1u);
+        reserveChars(domainSize + nameSize + 2u);
+        Entry const e{appendString(domain, domainSize),
+                      appendString(name, nameSize),
+                      size_};
+        m_entries.push_back(e);
+    }
+
+    /** \brief Appends a copy of the given type. */
+    void push_back(SharemindTdbType const & val) {
+        reserveFor(val);
+        if (m_entries.size() == m_entries.capacity())
+            m_entries.reserve(m_entries.size() * 2u + 1u);
+        m_entries.push_back(appendType(val));
+    }
+
+    /** \brief Takes ownership of val on success. */
+    void push_back(SharemindTdbType * val) {
+        assert(val);
+        push_back(static_cast<SharemindTdbType const &>(*val));
+        tdb_heap_clone_allocator::deallocate_clone(val);
+    }
+
+    void pop_back() {
+        if (m_entries.empty())
+            throw std::out_of_range("pop_back() on empty vector");
+        auto const & e = m_entries.back();
+        auto const end = (e.domain != noString) ? e.domain
+                       : (e.name != noString) ? e.name
+                       : m_chars.size();
+        m_entries.pop_back();
+        m_chars.resize(end);
+    }
+
+    void clear() noexcept {
+        m_entries.clear();
+        m_chars.clear();
+    }
+
+    std::uint64_t bytes() const noexcept {
+        return m_chars.capacity()
+               + m_entries.capacity() * sizeof(Entry)
+               + m_viewValues.capacity() * sizeof(SharemindTdbType)
+               + m_view.capacity() * sizeof(SharemindTdbType *);
+    }
+
+    void getCArray(SharemindTdbType **& array, size_type & size_) {
+        auto const n = m_entries.size();
+        m_viewValues.resize(n);
+        m_view.resize(n);
+        for (size_type i = 0u; i < n; ++i) {
+            m_viewValues[i] = element(i);
+            m_view[i] = &m_viewValues[i];
+        }
+        array = m_view.empty() ? nullptr : m_view.data();
+        size_ = n;
+    }
+
+    /** \brief Takes ownership of the elements and the array on success. */
+    void setCArray(SharemindTdbType ** array, size_type const size_) {
+        size_type chars = 0u;
+        for (size_type i = 0u; i < size_; ++i) {
+            assert(array[i]);
+            chars += typeChars(*array[i]);
+        }
+        reserveChars(chars);
+        m_entries.reserve(m_entries.size() + size_);
+
+        // Nothing below throws, since the space has been reserved:
+        for (size_type i = 0u; i < size_; ++i) {
+            m_entries.push_back(appendType(*array[i]));
+            tdb_heap_clone_allocator::deallocate_clone(array[i]);
+        }
+        delete[] array;
+    }
+
+private: /* Methods: */
+
+    /** \pre Space for the string has been reserved. */
+    uint64_t appendString(char const * const str, size_type const size)
+            noexcept
+    {
+        auto const * const end = size
+                ? static_cast<char const *>(std::memchr(str, '\0', size))
+                : nullptr;
+        auto const length = end ? static_cast<size_type>(end - str) : size;
+        auto const offset = m_chars.size();
+        assert(m_chars.capacity() - offset > length);
+        m_chars.insert(m_chars.end(), str, str + length);
+        m_chars.push_back('\0');
+        return offset;
+    }
+
+    /** \brief Reserves arena space for n more characters. */
+    void reserveChars(size_type const n) {
+        if (m_chars.capacity() - m_chars.size() < n)
+            m_chars.reserve(std::max(m_chars.size() + n,
+                                     m_chars.capacity() * 2u));
+    }
+
+    /** \returns the arena space the strings of the given type take. */
+    static size_type typeChars(SharemindTdbType const & type) noexcept {
+        size_type chars = 0u;
+        if (type.domain)
+            chars += std::strlen(type.domain) + 1u;
+        if (type.name)
+            chars += std::strlen(type.name) + 1u;
+        return chars;
+    }
+
+    /** \brief Reserves arena space for the strings of the given type. */
+    void reserveFor(SharemindTdbType const & type)
+    { reserveChars(typeChars(type)); }
+
+    /** \pre Space for the strings of the type has been reserved. */
+    Entry appendType(SharemindTdbType const & type) noexcept {
+        Entry e;
+        e.domain = type.domain
+                   ? appendString(type.domain, std::strlen(type.domain))
+                   : noString;
+        e.name = type.name
+                 ? appendString(type.name, std::strlen(type.name))
+                 : noString;
+        e.size = type.size;
+        return e;
+    }
+
+    char * string(uint64_t const offset) const noexcept {
+        return (offset != noString)
+               ? const_cast<char *>(m_chars.data()) + offset
+               : nullptr;
+    }
+
+    SharemindTdbType element(size_type const n) const noexcept {
+        auto const & e = m_entries[n];
+        return SharemindTdbType{string(e.domain), string(e.name), e.size};
+    }
+
+private: /* Fields: */
+
+    std::vector<char> m_chars;
+    std::vector<Entry> m_entries;
+    std::vector<SharemindTdbType> m_viewValues;
+    std::vector<SharemindTdbType *> m_view;
+
+}; /* class TdbVectorStorage<SharemindTdbType> { */
+
+/**
+  \brief Value vectors keep all payloads in a single byte arena indexed by an
+         offsets array.
+
+  Types are interned per vector: every distinct type is stored once and
+  elements refer to it by index, hence the SharemindTdbType of the values
+  returned by at() and getCArray() is shared between all values of that type.
+
+  The payloads may instead reside in an external buffer handed over by a
+  database module, which is released through its callback once the vector no
+  longer needs it. Reads are served directly from the external buffer; the
+  first modification other than pop_back() copies it into the arena.
+
+  Given a spill policy, the arena moves to a memory-mapped file once it grows
+  beyond the spill threshold. Such payloads are not counted as held memory.
+*/
+template <>
+class __attribute__ ((visibility("internal")))
+        TdbVectorStorage<SharemindTdbValue>
+{
+
+private: /* Types: */
+
+    using TypeContainer =
+            boost::ptr_vector<SharemindTdbType, tdb_heap_clone_allocator>;
+
+    struct ExternalBuffer {
+
+        ExternalBuffer(void const * data_, void * context_) noexcept
+            : data(data_)
+            , context(context_)
+        {}
+
+        ExternalBuffer(ExternalBuffer const &) = delete;
+        ExternalBuffer & operator=(ExternalBuffer const &) = delete;
+
+        ~ExternalBuffer() noexcept {
+            if (release)
+                release(context);
+        }
+
+        void const * data;
+        void (* release)(void * context) = nullptr;
+        void * context;
+
+    };
+
+public: /* Types: */
+
+    using size_type = TypeContainer::size_type;
+    using TypeIndex = uint32_t;
+
+    /* Memory held for every element in addition to its payload: */
+    static constexpr std::uint64_t elementBytes =
+            sizeof(uint64_t) + sizeof(TypeIndex);
+
+    /* Elements are returned as views into the arena: */
+    using reference = SharemindTdbValue;
+    using const_reference = SharemindTdbValue;
+
+public: /* Methods: */
+
+    size_type size() const noexcept { return m_typeIndexes.size(); }
+
+    reference at(size_type const n) const {
+        if (n >= m_typeIndexes.size())
+            throw std::out_of_range("value vector index out of range");
+        return element(n);
+    }
+
+    /** \brief Takes ownership of type on success. */
+    void push_back(SharemindTdbType * type,
+                   void const * buffer,
+                   uint64_t const size)
+    {
+        assert(type);
+        assert(buffer || size == 0u);
+        detach();
+        auto const oldArenaSize = m_arena.size();
+        reserveMore(m_offsets);
+        reserveMore(m_typeIndexes);
+        reserveMore(m_types);
+        m_arena.resize(oldArenaSize + size);
+        if (size)
+            std::memcpy(m_arena.data() + oldArenaSize, buffer, size);
+        m_offsets.push_back(m_arena.size());
+        m_typeIndexes.push_back(internType(type));
+    }
+
+    /**
+      \brief Appends n values of the given type, each elemSize bytes long.
+      \param[in] data the contiguous payloads of all n values.
+    */
+    void append(SharemindTdbType const & type,
+                void const * data,
+                size_type const n,
+                uint64_t const elemSize)
+    {
+        assert(data || !n || !elemSize);
+        if (!n)
+            return;
+        detach();
+        auto const typeIndex = findType(type);
+        if (typeIndex == m_types.size()) {
+            reserveMore(m_types);
+            m_types.push_back(tdb_heap_clone_allocator::allocate_clone(type));
+            m_typeBytes += typeBytes(type);
+        }
+        auto const oldArenaSize = m_arena.size();
+        reserveMore(m_offsets, n);
+        reserveMore(m_typeIndexes, n);
+        m_arena.resize(oldArenaSize + n * elemSize);
+        if (elemSize)
+            std::memcpy(m_arena.data() + oldArenaSize, data, n * elemSize);
+        for (size_type i = 1u; i <= n; ++i)
+            m_offsets.push_back(oldArenaSize + i * elemSize);
+        m_typeIndexes.insert(m_typeIndexes.end(), n, typeIndex);
+    }
+
+    /** \brief Takes ownership of val on success. */
+    void push_back(SharemindTdbValue * val) {
+        assert(val);
+        push_back(val->type, val->buffer, val->size);
+        ::operator delete(val->buffer);
+        boost::checked_delete(val);
+    }
+
+    void pop_back() {
+        if (m_typeIndexes.empty())
+            throw std::out_of_range("pop_back() on empty vector");
+        m_typeIndexes.pop_back();
+        m_offsets.pop_back();
+        if (!m_external)
+            m_arena.resize(m_offsets.back());
+    }
+
+    void clear() noexcept {
+        m_typeIndexes.clear();
+        m_types.clear();
+        m_typeBytes = 0u;
+        m_offsets.resize(1u);
+        m_arena.clear();
+        m_external.reset();
+    }
+
+    /**
+      \brief Makes the n values of the given type stored in an external buffer
+             the contents of this empty vector.
+      \param[in] offsets n+1 ascending offsets of the payloads in data, or
+                         nullptr if every payload is type.size bytes long.
+      \param[in] release called with context once the buffer is no longer
+                         needed, but only if this function succeeds.
+    */
+    void setExternal(SharemindTdbType const & type,
+                     void const * data,
+                     uint64_t const * offsets,
+                     size_type const n,
+                     void (* release)(void * context),
+                     void * context)
+    {
+        assert(!size());
+        assert(m_types.empty());
+        std::vector<uint64_t> newOffsets;
+        if (offsets) {
+            newOffsets.assign(offsets, offsets + n + 1u);
+        } else {
+            newOffsets.resize(n + 1u);
+            for (size_type i = 0u; i <= n; ++i)
+                newOffsets[i] = i * type.size;
+        }
+        std::vector<TypeIndex> newTypeIndexes(n, 0u);
+        std::unique_ptr<ExternalBuffer> external(
+                    new ExternalBuffer(data, context));
+        m_types.push_back(tdb_heap_clone_allocator::allocate_clone(type));
+        m_typeBytes = typeBytes(type);
+
+        // Nothing below throws:
+        m_offsets = std::move(newOffsets);
+        m_typeIndexes = std::move(newTypeIndexes);
+        m_arena.clear();
+        external->release = release;
+        m_external = std::move(external);
+    }
+
+    /**
+      \returns the payload offsets array of size()+1 elements. The payload of
+               value i is at payload() + offsets()[i] and ends at
+               payload() + offsets()[i + 1].
+    */
+    uint64_t const * offsets() const noexcept { return m_offsets.data(); }
+
+    /** \returns the number of distinct types of the values. */
+    size_type typeCount() const noexcept { return m_types.size(); }
+
+    SharemindTdbType const & type(TypeIndex const index) const noexcept {
+        assert(index < m_types.size());
+        return m_types[index];
+    }
+
+    /**
+      \returns the array of size() indexes of the types of the values, as
+               given to type().
+    */
+    TypeIndex const * typeIndexes() const noexcept
+    { return m_typeIndexes.data(); }
+
+    unsigned char const * payload() const noexcept {
+        return m_external
+               ? static_cast<unsigned char const *>(m_external->data)
+               : m_arena.data();
+    }
+
+    void setSpillPolicy(std::shared_ptr<TdbSpillPolicy const> policy) noexcept
+    { m_arena.setSpillPolicy(std::move(policy)); }
+
+    /** \returns whether the payloads reside in a spill file. */
+    bool spilled() const noexcept { return m_arena.spilled(); }
+
+    /**
+      \returns the number of bytes of the given payload size which would be
+               held in memory if appended to this vector.
+    */
+    std::uint64_t residentPayloadBytes(std::uint64_t const bytes)
+            const noexcept
+    {
+        auto const arenaSize = m_external ? m_offsets.back() : m_arena.size();
+        return m_arena.spills(arenaSize + bytes) ? 0u : bytes;
+    }
+
+    /** \brief Counts an external buffer as held by this vector. */
+    std::uint64_t bytes() const noexcept {
+        return (m_external ? m_offsets.back() : m_arena.residentBytes())
+               + m_offsets.capacity() * sizeof(uint64_t)
+               + m_typeIndexes.capacity() * sizeof(TypeIndex)
+               + m_typeBytes
+               + m_viewValues.capacity() * sizeof(SharemindTdbValue)
+               + m_view.capacity() * sizeof(SharemindTdbValue *);
+    }
+
+    void getCArray(SharemindTdbValue **& array, size_type & size) {
+        auto const n = m_typeIndexes.size();
+        m_viewValues.resize(n);
+        m_view.resize(n);
+        for (size_type i = 0u; i < n; ++i) {
+            m_viewValues[i] = element(i);
+            m_view[i] = &m_viewValues[i];
+        }
+        array = m_view.empty() ? nullptr : m_view.data();
+        size = n;
+    }
+
+    /** \brief Takes ownership of the elements and the array on success. */
+    void setCArray(SharemindTdbValue ** array, size_type const size) {
+        uint64_t bytes = 0u;
+        std::vector<SharemindTdbType const *> newTypes;
+        for (size_type i = 0u; i < size; ++i) {
+            assert(array[i]);
+            assert(array[i]->type);
+            bytes += array[i]->size;
+            auto const & type = *array[i]->type;
+            if (findType(type) == m_types.size()
+                && std::none_of(newTypes.begin(),
+                                newTypes.end(),
+                                [&type](SharemindTdbType const * t) noexcept
+                                { return equalTypes(*t, type); }))
+                newTypes.push_back(&type);
+        }
+        detach();
+        m_arena.reserve(m_arena.size() + bytes);
+        reserveMore(m_offsets, size);
+        reserveMore(m_typeIndexes, size);
+        reserveMore(m_types, newTypes.size());
+
+        // Nothing below throws, since the space has been reserved:
+        for (size_type i = 0u; i < size; ++i) {
+            SharemindTdbValue * const v = array[i];
+            auto const oldArenaSize = m_arena.size();
+            m_arena.resize(oldArenaSize + v->size);
+            if (v->size)
+                std::memcpy(m_arena.data() + oldArenaSize,
+                            v->buffer,
+                            v->size);
+            m_offsets.push_back(m_arena.size());
+            m_typeIndexes.push_back(internType(v->type));
+            ::operator delete(v->buffer);
+            boost::checked_delete(v);
+        }
+        delete[] array;
+    }
+
+private: /* Methods: */
+
+    /** \brief Copies the payloads from the external buffer into the arena. */
+    void detach() {
+        if (!m_external)
+            return;
+        auto const * const data =
+                static_cast<unsigned char const *>(m_external->data);
+        m_arena.assign(data, data + m_offsets.back());
+        m_external.reset();
+    }
+
+    /** \brief Reserves space for n more elements, growing geometrically. */
+    template <typename C>
+    static void reserveMore(C & c, size_type const n = 1u) {
+        if (c.capacity() - c.size() < n)
+            c.reserve(std::max(c.size() + n, c.capacity() * 2u));
+    }
+
+    static bool equalStrings(char const * const a, char const * const b)
+            noexcept
+    { return (a && b) ? !std::strcmp(a, b) : a == b; }
+
+    static bool equalTypes(SharemindTdbType const & a,
+                           SharemindTdbType const & b) noexcept
+    {
+        return a.size == b.size
+               && equalStrings(a.name, b.name)
+               && equalStrings(a.domain, b.domain);
+    }
+
+    /**
+      \returns the index of the interned type equal to the given type or the
+               number of interned types if there is none. Vectors usually hold
+               values of only a few distinct types, most recently used last.
+    */
+    TypeIndex findType(SharemindTdbType const & type) const noexcept {
+        for (auto i = m_types.size(); i--;)
+            if (equalTypes(m_types[i], type))
+                return static_cast<TypeIndex>(i);
+        return static_cast<TypeIndex>(m_types.size());
+    }
+
+    /**
+      \brief Takes ownership of type, which is deleted if an equal type has
+             already been interned.
+      \pre Space for one more type has been reserved.
+    */
+    TypeIndex internType(SharemindTdbType * type) noexcept {
+        auto const index = findType(*type);
+        if (index < m_types.size()) {
+            tdb_heap_clone_allocator::deallocate_clone(type);
+        } else {
+            assert(m_types.size() < m_types.capacity());
+            m_types.push_back(type);
+            m_typeBytes += typeBytes(*type);
+        }
+        return index;
+    }
+
+    /** \returns the memory held by an interned type. */
+    static std::uint64_t typeBytes(SharemindTdbType const & type) noexcept {
+        return sizeof(SharemindTdbType)
+               + (type.domain ? std::strlen(type.domain) + 1u : 0u)
+               + (type.name ? std::strlen(type.name) + 1u : 0u);
+    }
+
+    SharemindTdbValue element(size_type const n) const noexcept {
+        auto const offset = m_offsets[n];
+        auto const size = m_offsets[n + 1u] - offset;
+        return SharemindTdbValue{
+                    const_cast<SharemindTdbType *>(&m_types[m_typeIndexes[n]]),
+                    size
+                    ? const_cast<unsigned char *>(payload()) + offset
+                    : nullptr,
+                    size};
+    }
+
+private: /* Fields: */
+
+    TdbValueArena m_arena;
+    std::vector<uint64_t> m_offsets{0u};
+    std::vector<TypeIndex> m_typeIndexes;
+    TypeContainer m_types;
+    std::uint64_t m_typeBytes = 0u;
+    std::unique_ptr<ExternalBuffer> m_external;
+    std::vector<SharemindTdbValue> m_viewValues;
+    std::vector<SharemindTdbValue *> m_view;
+
+}; /* class TdbVectorStorage<SharemindTdbValue> { */
+
+} /* namespace sharemind { */
+
+#endif /* SHAREMIND_MOD_TABLEDB_TDBVECTORSTORAGE_H */
@@ -17,24 +17,234 @@
  * For further information, please contact us at sharemind@cyber.ee.
  */
 
+#include <algorithm>
+#include <boost/utility/string_view.hpp>
 #include <cassert>
+#include <cstring>
 #include <LogHard/Logger.h>
+#include <memory>
+#include <mutex>
 #include <sharemind/AccessControlProcessFacility.h>
 #include <sharemind/module-apis/api_0x1.h>
 #include <sharemind/libprocessfacility.h>
 #include <sharemind/StringHashTablePredicate.h>
 #include <string>
 #include <vector>
+#include "TdbAclCache.h"
+#include "TdbProcessContext.h"
+#include "TdbCursorTable.h"
 #include "TdbModule.h"
+#include "TdbTableCache.h"
 #include "TdbTypesUtil.h"
 
 #include "TdbVectorMap.h"
+#include "TdbVectorMapSnapshot.h"
+#include "tdbcapabilities.h"
 
 
 using namespace sharemind;
 
+/* Syscalls forwarded to the database modules: */
+#define MOD_TABLEDB_DB_SYSCALLS(f) \
+    f(tdb_open) \
+    f(tdb_close) \
+    f(tdb_table_names) \
+    f(tdb_tbl_create) \
+    f(tdb_tbl_create2) \
+    f(tdb_tbl_delete) \
+    f(tdb_tbl_exists) \
+    f(tdb_tbl_col_count) \
+    f(tdb_tbl_col_names) \
+    f(tdb_tbl_col_types) \
+    f(tdb_tbl_row_count) \
+    f(tdb_insert_row) \
+    f(tdb_insert_row2) \
+    f(tdb_read_col) \
+    f(tdb_get_attributes) \
+    f(tdb_set_attributes)
+
+/*
+  Syscalls forwarded to the database modules that support them. These are
+  looked up as optional syscall signatures.
+*/
+#define MOD_TABLEDB_OPTIONAL_DB_SYSCALLS(f) \
+    f(tdb_delete_col) \
+    f(tdb_delete_row) \
+    f(tdb_insert_col) \
+    f(tdb_read_row) \
+    f(tdb_update_col) \
+    f(tdb_update_row) \
+    f(tdb_read_col_open) \
+    f(tdb_read_col_next) \
+    f(tdb_read_col_close) \
+    f(tdb_batch_exec)
+
+/* All syscalls of this module: */
+#define MOD_TABLEDB_SYSCALLS(f) \
+    f(tdb_error_code) \
+    MOD_TABLEDB_DB_SYSCALLS(f) \
+    MOD_TABLEDB_OPTIONAL_DB_SYSCALLS(f) \
+    f(tdb_capabilities) \
+    f(tdb_insert_row_async) \
+    f(tdb_read_col_async) \
+    f(tdb_wait) \
+    f(tdb_poll) \
+    f(tdb_vmap_new) \
+    f(tdb_vmap_delete) \
+    f(tdb_vmap_size_index) \
+    f(tdb_vmap_at_index) \
+    f(tdb_vmap_read_index_vector) \
+    f(tdb_vmap_push_back_index) \
+    f(tdb_vmap_push_back_index_vector) \
+    f(tdb_vmap_pop_back_index) \
+    f(tdb_vmap_clear_index) \
+    f(tdb_vmap_is_index_vector) \
+    f(tdb_vmap_size_string) \
+    f(tdb_vmap_at_string) \
+    f(tdb_vmap_read_string_vector) \
+    f(tdb_vmap_push_back_string) \
+    f(tdb_vmap_pop_back_string) \
+    f(tdb_vmap_clear_string) \
+    f(tdb_vmap_is_string_vector) \
+    f(tdb_vmap_size_type) \
+    f(tdb_vmap_at_type_domain) \
+    f(tdb_vmap_at_type_name) \
+    f(tdb_vmap_at_type_size) \
+    f(tdb_vmap_push_back_type) \
+    f(tdb_vmap_pop_back_type) \
+    f(tdb_vmap_clear_type) \
+    f(tdb_vmap_is_type_vector) \
+    f(tdb_vmap_size_value) \
+    f(tdb_vmap_at_value_type_domain) \
+    f(tdb_vmap_at_value_type_name) \
+    f(tdb_vmap_at_value_type_size) \
+    f(tdb_vmap_at_value) \
+    f(tdb_vmap_read_value_vector) \
+    f(tdb_vmap_push_back_value) \
+    f(tdb_vmap_push_back_value_vector) \
+    f(tdb_vmap_pop_back_value) \
+    f(tdb_vmap_clear_value) \
+    f(tdb_vmap_is_value_vector) \
+    f(tdb_vmap_count) \
+    f(tdb_vmap_erase) \
+    f(tdb_vmap_clear) \
+    f(tdb_vmap_reset) \
+    f(tdb_vmap_set_batch) \
+    f(tdb_vmap_add_batch) \
+    f(tdb_vmap_batch_count) \
+    f(tdb_vmap_memory_usage) \
+    f(tdb_vmap_save) \
+    f(tdb_vmap_load)
+
 namespace {
 
+/*
+  Indexes of the forwarded syscalls in the required signature list followed by
+  the optional signature list:
+*/
+enum DbSyscall : std::size_t {
+#define MOD_TABLEDB_DB_SYSCALL_ENUM(name) DbSyscall_ ## name,
+    MOD_TABLEDB_DB_SYSCALLS(MOD_TABLEDB_DB_SYSCALL_ENUM)
+    MOD_TABLEDB_OPTIONAL_DB_SYSCALLS(MOD_TABLEDB_DB_SYSCALL_ENUM)
+#undef MOD_TABLEDB_DB_SYSCALL_ENUM
+    DbSyscall_count
+};
+
+/* The capability bits follow the order of the optional signatures: */
+constexpr std::uint64_t capabilityBit(DbSyscall const syscall) noexcept
+{ return std::uint64_t(1u) << (syscall - DbSyscall_tdb_delete_col); }
+
+#define MOD_TABLEDB_CHECK_CAPABILITY(name, cap) \
+    static_assert(capabilityBit(DbSyscall_ ## name) \
+                  == SHAREMIND_TDB_CAPABILITY_ ## cap, "");
+MOD_TABLEDB_CHECK_CAPABILITY(tdb_delete_col, DELETE_COL)
+MOD_TABLEDB_CHECK_CAPABILITY(tdb_delete_row, DELETE_ROW)
+MOD_TABLEDB_CHECK_CAPABILITY(tdb_insert_col, INSERT_COL)
+MOD_TABLEDB_CHECK_CAPABILITY(tdb_read_row, READ_ROW)
+MOD_TABLEDB_CHECK_CAPABILITY(tdb_update_col, UPDATE_COL)
+MOD_TABLEDB_CHECK_CAPABILITY(tdb_update_row, UPDATE_ROW)
+MOD_TABLEDB_CHECK_CAPABILITY(tdb_read_col_open, READ_COL_OPEN)
+MOD_TABLEDB_CHECK_CAPABILITY(tdb_read_col_next, READ_COL_NEXT)
+MOD_TABLEDB_CHECK_CAPABILITY(tdb_read_col_close, READ_COL_CLOSE)
+MOD_TABLEDB_CHECK_CAPABILITY(tdb_batch_exec, BATCH_EXEC)
+#undef MOD_TABLEDB_CHECK_CAPABILITY
+static_assert(DbSyscall_count - DbSyscall_tdb_delete_col == 10u,
+              "Update tdbcapabilities.h!");
+
+/* How the forwarded syscalls use the table cache of a data source: */
+TdbTableCache::Use tableCacheUse(DbSyscall const syscall) noexcept {
+    using C = TdbTableCache;
+    switch (syscall) {
+        case DbSyscall_tdb_tbl_exists:    return {C::Exists, 0u};
+        case DbSyscall_tdb_tbl_col_count: return {C::ColCount, 0u};
+        case DbSyscall_tdb_tbl_col_names: return {C::ColNames, 0u};
+        case DbSyscall_tdb_tbl_col_types: return {C::ColTypes, 0u};
+        case DbSyscall_tdb_tbl_row_count: return {C::RowCount, 0u};
+        case DbSyscall_tdb_tbl_create:
+        case DbSyscall_tdb_tbl_create2:
+        case DbSyscall_tdb_tbl_delete:
+        case DbSyscall_tdb_delete_col:
+        case DbSyscall_tdb_insert_col:
+            return {C::NoEntry, C::AllEntries};
+        case DbSyscall_tdb_insert_row:
+        case DbSyscall_tdb_insert_row2:
+        case DbSyscall_tdb_delete_row:
+            return {C::NoEntry, C::RowEntries};
+        default:
+            return {C::NoEntry, 0u};
+    }
+}
+
+/* Indexes of all syscalls in the syscall statistics: */
+enum Syscall : std::size_t {
+#define MOD_TABLEDB_SYSCALL_ENUM(name) Syscall_ ## name,
+    MOD_TABLEDB_SYSCALLS(MOD_TABLEDB_SYSCALL_ENUM)
+#undef MOD_TABLEDB_SYSCALL_ENUM
+    Syscall_count
+};
+
+using SyscallFunction =
+        SharemindModuleApi0x1Error (*)(
+            SharemindCodeBlock * args,
+            size_t num_args,
+            const SharemindModuleApi0x1Reference * refs,
+            const SharemindModuleApi0x1CReference * crefs,
+            SharemindCodeBlock * returnValue,
+            SharemindModuleApi0x1SyscallContext * c);
+
+/* Records the call count, error count and latency of every call to F: */
+template <SyscallFunction F, Syscall S>
+SharemindModuleApi0x1Error instrumentedSyscall(
+        SharemindCodeBlock * args,
+        size_t num_args,
+        const SharemindModuleApi0x1Reference * refs,
+        const SharemindModuleApi0x1CReference * crefs,
+        SharemindCodeBlock * returnValue,
+        SharemindModuleApi0x1SyscallContext * c)
+{
+    assert(c);
+    assert(c->moduleHandle);
+    auto & m = *static_cast<sharemind::TdbModule *>(c->moduleHandle);
+    auto const start(TdbStatistics::Clock::now());
+
+    // Resolve the process context once for all lookups during this call:
+    TdbProcessContext * const process = m.processContext(c);
+    sharemind::TdbModule::ProcessContextScope const scope(c, process);
+
+    // Keep workers running asynchronous calls of the process off its stores:
+    std::unique_lock<std::mutex> processLock;
+    if (process
+        && process->async().used()
+        && S != Syscall_tdb_wait
+        && S != Syscall_tdb_poll)
+        processLock = std::unique_lock<std::mutex>(process->async().mutex());
+
+    auto const r = F(args, num_args, refs, crefs, returnValue, c);
+    m.statistics().syscall(S).record(TdbStatistics::Clock::now() - start,
+                                     r != SHAREMIND_MODULE_API_0x1_OK);
+    return r;
+}
+
 #define P getOrCreateTemporaryStringHashTablePredicate
 
 auto const rulesetNameRange(asLiteralStringRange("sharemind:tabledb"));
@@ -42,56 +252,104 @@ auto const rulesetNamePredicate(P(rulesetNameRange));
 auto const wildcardObjectNameRange(asLiteralStringRange("*:*"));
 auto const wildcardObjectNamePredicate(P(wildcardObjectNameRange));
 
-bool checkPermission(AccessControlProcessFacility const & aclFacility,
-                     std::string const & ds,
-                     std::string const & prog)
+template <typename Permissions>
+bool checkDataSourcePermission(Permissions const & perms,
+                               std::string const & ds,
+                               std::string const & prog)
 {
-    return aclFacility.check(
-                rulesetNamePredicate,
+    return perms.checkAccess(
                 P(ds + ':' + prog),
                 P(ds + ":*"),
-                P(std::string("*:") + prog),
+                P("*:" + prog),
                 wildcardObjectNamePredicate) == AccessResult::Allowed;
 }
 
-bool checkPermission(AccessControlProcessFacility const & aclFacility,
-                     std::string const & ds,
-                     std::string const & tbl,
-                     std::string const & perm,
-                     std::string const & prog)
+template <typename Permissions>
+bool checkTablePermission(Permissions const & perms,
+                          std::string const & ds,
+                          std::string const & tbl,
+                          std::string const & perm,
+                          std::string const & prog)
 {
     static auto const wildcardObjectNameRange2(asLiteralStringRange("*:*:*:*"));
     static auto const wildcardObjectNamePredicate2(P(wildcardObjectNameRange2));
 
+    if (!checkDataSourcePermission(perms, ds, prog))
+        return false;
+    return perms.checkAccess(
+                P(ds + ':' + tbl + ':' + perm + ':' + prog),
+                P(ds + ':' + tbl + ':' + perm + ":*"),
+                P(ds + ':' + tbl + ":*:" + prog),
+                P(ds + ':' + tbl + ":*:*"),
+                P(ds + ":*:" + perm + ':' + prog),
+                P(ds + ":*:" + perm + ":*"),
+                P(ds + ":*:*:" + prog),
+                P(ds + ":*:*:*"),
+                P("*:" + tbl + ':' + perm + ':' + prog),
+                P("*:" + tbl + ':' + perm + ":*"),
+                P("*:" + tbl + ":*:" + prog),
+                P("*:" + tbl + ":*:*"),
+                P("*:*:" + perm + ':' + prog),
+                P("*:*:" + perm + ":*"),
+                P("*:*:*:" + prog),
+                wildcardObjectNamePredicate2
+            ) == AccessResult::Allowed;
+}
+
+/*
+  Decisions are cached by the data source, table and permission names, which
+  only leaves the policy lookup and the cache lookup on the hot path. Checks
+  of access to the data source itself are made with an empty table and
+  permission, table permissions are never empty.
+*/
+bool checkPermission(TdbAclCache * const cache,
+                     AccessControlProcessFacility const & aclFacility,
+                     boost::string_view const ds,
+                     boost::string_view const tbl,
+                     boost::string_view const perm,
+                     std::string const & prog)
+{
     if (auto const perms = aclFacility.currentPermissions(rulesetNamePredicate))
     {
-        if (perms->checkAccess(
-                P(ds + ':' + prog),
-                P(ds + ":*"),
-                P("*:" + prog),
-                wildcardObjectNamePredicate) != AccessResult::Allowed)
-            return false;
-        return perms->checkAccess(
-                    P(ds + ':' + tbl + ':' + perm + ':' + prog),
-                    P(ds + ':' + tbl + ':' + perm + ":*"),
-                    P(ds + ':' + tbl + ":*:" + prog),
-                    P(ds + ':' + tbl + ":*:*"),
-                    P(ds + ":*:" + perm + ':' + prog),
-                    P(ds + ":*:" + perm + ":*"),
-                    P(ds + ":*:*:" + prog),
-                    P(ds + ":*:*:*"),
-                    P("*:" + tbl + ':' + perm + ':' + prog),
-                    P("*:" + tbl + ':' + perm + ":*"),
-                    P("*:" + tbl + ":*:" + prog),
-                    P("*:" + tbl + ":*:*"),
-                    P("*:*:" + perm + ':' + prog),
-                    P("*:*:" + perm + ":*"),
-                    P("*:*:*:" + prog),
-                    wildcardObjectNamePredicate2
-                ) == AccessResult::Allowed;
+        if (cache) {
+            // The decision only depends on the policy and the arguments:
+            cache->validate(perms);
+            if (bool const * const allowed = cache->find(ds, tbl, perm))
+                return *allowed;
+        }
+
+        bool const allowed =
+                perm.empty()
+                ? checkDataSourcePermission(*perms, ds.to_string(), prog)
+                : checkTablePermission(*perms,
+                                       ds.to_string(),
+                                       tbl.to_string(),
+                                       perm.to_string(),
+                                       prog);
+        if (cache)
+            cache->insert(ds.to_string(),
+                          tbl.to_string(),
+                          perm.to_string(),
+                          allowed);
+        return allowed;
     }
+    if (cache)
+        cache->clear();
     return false;
 }
+
+bool checkPermission(TdbAclCache * const cache,
+                     AccessControlProcessFacility const & aclFacility,
+                     boost::string_view const ds,
+                     std::string const & prog)
+{
+    return checkPermission(cache,
+                           aclFacility,
+                           ds,
+                           boost::string_view(),
+                           boost::string_view(),
+                           prog);
+}
 #undef P
 
 template < size_t NumArgs
@@ -158,7 +416,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_error_code,
         return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
 
     try {
-        const std::string dsName(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const char * const dsName = static_cast<const char *>(crefs[0u].pData);
 
         sharemind::TdbModule * m = static_cast<sharemind::TdbModule *>(c->moduleHandle);
 
@@ -186,15 +444,22 @@ bool haveNtcsRefs(Ref * refs, std::size_t howManyToCheck) noexcept {
 }
 
 template <typename T>
-std::string refToString(T const & ref)
-{ return std::string(static_cast<char const *>(ref.pData), ref.size - 1u); }
+boost::string_view refToStringView(T const & ref) noexcept {
+    return boost::string_view(static_cast<char const *>(ref.pData),
+                              ref.size - 1u);
+}
 
-template <typename T>
-T * getFacility(SharemindModuleApi0x1SyscallContext & c,
-                char const * const facilityName) noexcept
+SharemindModuleApi0x1Error getProcessContext(
+        sharemind::TdbModule & m,
+        SharemindModuleApi0x1SyscallContext * c,
+        TdbProcessContext *& process) noexcept
 {
-    auto * const f = c.processFacility(&c, facilityName);
-    return f ? static_cast<T *>(f) : nullptr;
+    process = m.processContext(c);
+    if (!process)
+        return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+    if (!process->aclFacility() || !process->processFacility())
+        return SHAREMIND_MODULE_API_0x1_MISSING_FACILITY;
+    return SHAREMIND_MODULE_API_0x1_OK;
 }
 
 #define MOD_TABLEDB_FORWARD_SYSCALL(syscallName, numCheckArgs, ...) \
@@ -206,26 +471,21 @@ T * getFacility(SharemindModuleApi0x1SyscallContext & c,
         if (!haveNtcsRefs(crefs, numCheckArgs)) \
             return SHAREMIND_MODULE_API_0x1_INVALID_CALL; \
         try { \
-            auto const dsName(refToString(crefs[0u])); \
+            auto const dsName(refToStringView(crefs[0u])); \
             sharemind::TdbModule & m = \
                     *static_cast<sharemind::TdbModule *>(c->moduleHandle); \
-            auto const * aclFacility = \
-                    getFacility<AccessControlProcessFacility>( \
-                        *c, \
-                        "AccessControlProcessFacility"); \
-            if (!aclFacility) \
-                return SHAREMIND_MODULE_API_0x1_MISSING_FACILITY; \
-            auto const * processFacility = \
-                    getFacility<SharemindProcessFacility>( \
-                        *c, \
-                        "ProcessFacility"); \
-            if (!processFacility) \
-                return SHAREMIND_MODULE_API_0x1_MISSING_FACILITY; \
-            std::string const programName( \
-                    processFacility->programName(processFacility)); \
+            TdbProcessContext * process; \
+            auto const pr = getProcessContext(m, c, process); \
+            if (pr != SHAREMIND_MODULE_API_0x1_OK) \
+                return pr; \
+            auto const * aclFacility = process->aclFacility(); \
+            auto const aclStart(TdbStatistics::Clock::now()); \
+            std::string const & programName = process->programName(); \
             __VA_ARGS__ \
-            return m.doSyscall(dsName, #syscallName, args, num_args, refs, \
-                               crefs, returnValue, c); \
+            return m.doSyscall(dsName, \
+                               DbSyscall_ ## syscallName, \
+                               TdbStatistics::Clock::now() - aclStart, \
+                               args, num_args, refs, crefs, returnValue, c); \
         } catch (const std::bad_alloc &) { \
             return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY; \
         } catch (...) { \
@@ -236,15 +496,19 @@ T * getFacility(SharemindModuleApi0x1SyscallContext & c,
     MOD_TABLEDB_FORWARD_SYSCALL( \
         syscallName, \
         1u, \
-        if (!checkPermission(*aclFacility, dsName, programName)) \
+        if (!checkPermission(&process->aclCache(), \
+                             *aclFacility, \
+                             dsName, \
+                             programName)) \
             return SHAREMIND_MODULE_API_0x1_ACCESS_DENIED; \
         )
 #define MOD_TABLEDB_FORWARD_SYSCALL2(syscallName,permission)\
     MOD_TABLEDB_FORWARD_SYSCALL( \
         syscallName, \
         2u, \
-        auto const tblName(refToString(crefs[1u])); \
-        if (!checkPermission(*aclFacility, \
+        auto const tblName(refToStringView(crefs[1u])); \
+        if (!checkPermission(&process->aclCache(), \
+                             *aclFacility, \
                              dsName, \
                              tblName, \
                              permission, \
@@ -268,6 +532,620 @@ MOD_TABLEDB_FORWARD_SYSCALL2(tdb_insert_row2, "write")
 MOD_TABLEDB_FORWARD_SYSCALL2(tdb_read_col, "read")
 MOD_TABLEDB_FORWARD_SYSCALL2(tdb_get_attributes, "read")
 MOD_TABLEDB_FORWARD_SYSCALL2(tdb_set_attributes, "write")
+MOD_TABLEDB_FORWARD_SYSCALL2(tdb_delete_col, "write")
+MOD_TABLEDB_FORWARD_SYSCALL2(tdb_delete_row, "write")
+MOD_TABLEDB_FORWARD_SYSCALL2(tdb_insert_col, "write")
+MOD_TABLEDB_FORWARD_SYSCALL2(tdb_read_row, "read")
+MOD_TABLEDB_FORWARD_SYSCALL2(tdb_update_col, "write")
+MOD_TABLEDB_FORWARD_SYSCALL2(tdb_update_row, "write")
+
+/*
+  Column read cursors. tdb_read_col_open takes the same arguments as
+  tdb_read_col and returns a cursor handle. tdb_read_col_next takes the handle
+  and a row count n and returns what tdb_read_col would return for the next at
+  most n rows. tdb_read_col_close takes the handle and closes the cursor.
+
+  The database module returns its own cursor identifier from
+  tdb_read_col_open. For the other two syscalls it is given the data source
+  and table names as constant references and its cursor identifier as the
+  first argument, followed by the remaining arguments of the call. Handles of
+  cursors left open are dropped with the process, hence database modules
+  should keep their cursor state in their own process data store.
+*/
+
+SharemindModuleApi0x1Error checkTableAccess(
+        sharemind::TdbModule & m,
+        SharemindModuleApi0x1SyscallContext & c,
+        boost::string_view const dsName,
+        boost::string_view const tblName,
+        char const * const permission)
+{
+    TdbProcessContext * process;
+    auto const r = getProcessContext(m, &c, process);
+    if (r != SHAREMIND_MODULE_API_0x1_OK)
+        return r;
+    return checkPermission(&process->aclCache(),
+                           *process->aclFacility(),
+                           dsName,
+                           tblName,
+                           permission,
+                           process->programName())
+           ? SHAREMIND_MODULE_API_0x1_OK
+           : SHAREMIND_MODULE_API_0x1_ACCESS_DENIED;
+}
+
+SharemindModuleApi0x1Error forwardCursorSyscall(
+        sharemind::TdbModule & m,
+        TdbCursor const & cursor,
+        DbSyscall const syscall,
+        SharemindCodeBlock const * args,
+        size_t num_args,
+        SharemindCodeBlock * returnValue,
+        SharemindModuleApi0x1SyscallContext * c)
+{
+    // The cursor syscalls take at most the handle and a row count:
+    SharemindCodeBlock dbArgs[2u];
+    assert(num_args >= 1u && num_args <= 2u);
+    std::copy(args, args + num_args, dbArgs);
+    dbArgs[0u].uint64[0u] = cursor.dbCursorId;
+
+    auto const aclStart(TdbStatistics::Clock::now());
+    auto const access =
+            checkTableAccess(m, *c, cursor.dsName, cursor.tblName, "read");
+    if (access != SHAREMIND_MODULE_API_0x1_OK)
+        return access;
+
+    const SharemindModuleApi0x1CReference crefs[] = {
+        { cursor.dsName.c_str(), cursor.dsName.size() + 1u },
+        { cursor.tblName.c_str(), cursor.tblName.size() + 1u },
+        { nullptr, 0u }
+    };
+    return m.doSyscall(cursor.dsName,
+                       syscall,
+                       TdbStatistics::Clock::now() - aclStart,
+                       dbArgs,
+                       num_args,
+                       nullptr,
+                       crefs,
+                       returnValue,
+                       c);
+}
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_read_col_open,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    /* The other arguments will be checked by the submodules */
+    if (!returnValue || !crefs || !haveNtcsRefs(crefs, 2u))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    try {
+        auto const dsName(refToStringView(crefs[0u]));
+        auto const tblName(refToStringView(crefs[1u]));
+        sharemind::TdbModule & m =
+                *static_cast<sharemind::TdbModule *>(c->moduleHandle);
+
+        TdbCursorTable * const cursors = m.cursorTable(c);
+        if (!cursors)
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+
+        auto const aclStart(TdbStatistics::Clock::now());
+        auto const access = checkTableAccess(m, *c, dsName, tblName, "read");
+        if (access != SHAREMIND_MODULE_API_0x1_OK)
+            return access;
+
+        // Allocate the handle first, so that an open cursor is never lost:
+        auto const handle = cursors->insert(TdbCursor{dsName.to_string(), tblName.to_string(), 0u});
+        auto const r = m.doSyscall(dsName,
+                                   DbSyscall_tdb_read_col_open,
+                                   TdbStatistics::Clock::now() - aclStart,
+                                   args,
+                                   num_args,
+                                   refs,
+                                   crefs,
+                                   returnValue,
+                                   c);
+        if (r != SHAREMIND_MODULE_API_0x1_OK) {
+            cursors->erase(handle);
+            return r;
+        }
+
+        cursors->find(handle)->dbCursorId = returnValue->uint64[0u];
+        returnValue->uint64[0u] = handle;
+        return SHAREMIND_MODULE_API_0x1_OK;
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    } catch (...) {
+        return SHAREMIND_MODULE_API_0x1_MODULE_ERROR;
+    }
+}
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_read_col_next,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    if (!SyscallArgs<2u, true, 0u, 0u>::check(args, num_args, refs, crefs, returnValue))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    sharemind::TdbModule * m = static_cast<sharemind::TdbModule *>(c->moduleHandle);
+
+    try {
+        TdbCursorTable * const cursors = m->cursorTable(c);
+        if (!cursors)
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+
+        TdbCursor const * const cursor = cursors->find(args[0u].uint64[0u]);
+        if (!cursor) {
+            m->logger().error() << "Failed to read from cursor: invalid handle.";
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+        }
+
+        return forwardCursorSyscall(*m,
+                                    *cursor,
+                                    DbSyscall_tdb_read_col_next,
+                                    args,
+                                    num_args,
+                                    returnValue,
+                                    c);
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    } catch (...) {
+        return SHAREMIND_MODULE_API_0x1_MODULE_ERROR;
+    }
+}
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_read_col_close,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    if (!SyscallArgs<1u, false, 0u, 0u>::check(args, num_args, refs, crefs, returnValue))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    sharemind::TdbModule * m = static_cast<sharemind::TdbModule *>(c->moduleHandle);
+
+    try {
+        TdbCursorTable * const cursors = m->cursorTable(c);
+        if (!cursors)
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+
+        const uint64_t handle = args[0u].uint64[0u];
+        TdbCursor const * const cursor = cursors->find(handle);
+        if (!cursor) {
+            m->logger().error() << "Failed to close cursor: invalid handle.";
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+        }
+
+        auto const r = forwardCursorSyscall(*m,
+                                            *cursor,
+                                            DbSyscall_tdb_read_col_close,
+                                            args,
+                                            num_args,
+                                            returnValue,
+                                            c);
+        if (r == SHAREMIND_MODULE_API_0x1_OK)
+            cursors->erase(handle);
+        return r;
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    } catch (...) {
+        return SHAREMIND_MODULE_API_0x1_MODULE_ERROR;
+    }
+}
+
+/*
+  Asynchronous variants of tdb_insert_row and tdb_read_col. These take the same
+  arguments as the synchronous syscalls except for references, check access
+  immediately and return a call handle. The database module syscall is run on
+  a worker thread, in the order of the calls on the same data source.
+  tdb_wait takes a handle, waits for the call to complete and returns what the
+  synchronous syscall would have returned. tdb_poll takes a handle and returns
+  whether the call has completed. Vector maps given to a call must not be used
+  before waiting for it.
+*/
+
+SharemindModuleApi0x1Error forwardAsyncSyscall(
+        DbSyscall const syscall,
+        char const * const permission,
+        SharemindCodeBlock * args,
+        size_t num_args,
+        const SharemindModuleApi0x1Reference * refs,
+        const SharemindModuleApi0x1CReference * crefs,
+        SharemindCodeBlock * returnValue,
+        SharemindModuleApi0x1SyscallContext * c)
+{
+    /* The other arguments will be checked by the submodules */
+    if (!returnValue || (refs && refs[0u].pData) || !crefs
+        || !haveNtcsRefs(crefs, 2u))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    try {
+        auto const dsName(refToStringView(crefs[0u]));
+        auto const tblName(refToStringView(crefs[1u]));
+        sharemind::TdbModule & m =
+                *static_cast<sharemind::TdbModule *>(c->moduleHandle);
+
+        auto const aclStart(TdbStatistics::Clock::now());
+        auto const access =
+                checkTableAccess(m, *c, dsName, tblName, permission);
+        if (access != SHAREMIND_MODULE_API_0x1_OK)
+            return access;
+
+        uint64_t handle;
+        auto const r = m.doSyscallAsync(dsName,
+                                        syscall,
+                                        TdbStatistics::Clock::now() - aclStart,
+                                        args,
+                                        num_args,
+                                        crefs,
+                                        c,
+                                        handle);
+        if (r == SHAREMIND_MODULE_API_0x1_OK)
+            returnValue->uint64[0u] = handle;
+        return r;
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    } catch (...) {
+        return SHAREMIND_MODULE_API_0x1_MODULE_ERROR;
+    }
+}
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_insert_row_async,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    return forwardAsyncSyscall(DbSyscall_tdb_insert_row,
+                               "write",
+                               args,
+                               num_args,
+                               refs,
+                               crefs,
+                               returnValue,
+                               c);
+}
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_read_col_async,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    return forwardAsyncSyscall(DbSyscall_tdb_read_col,
+                               "read",
+                               args,
+                               num_args,
+                               refs,
+                               crefs,
+                               returnValue,
+                               c);
+}
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_wait,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    if (!SyscallArgs<1u, false, 0u, 0u>::check(args, num_args, refs, crefs, returnValue))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    sharemind::TdbModule * m = static_cast<sharemind::TdbModule *>(c->moduleHandle);
+
+    try {
+        TdbProcessContext * const process = m->processContext(c);
+        auto const handle = args[0u].uint64[0u];
+        auto const call(process ? process->async().find(handle) : nullptr);
+        if (!call) {
+            m->logger().error() << "Failed to wait for call: invalid handle.";
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+        }
+
+        SharemindCodeBlock rv;
+        auto const r = call->wait(rv);
+        process->async().erase(handle);
+        if (returnValue)
+            *returnValue = rv;
+        return r;
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    } catch (...) {
+        return SHAREMIND_MODULE_API_0x1_MODULE_ERROR;
+    }
+}
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_poll,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    if (!SyscallArgs<1u, true, 0u, 0u>::check(args, num_args, refs, crefs, returnValue))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    sharemind::TdbModule * m = static_cast<sharemind::TdbModule *>(c->moduleHandle);
+
+    try {
+        TdbProcessContext * const process = m->processContext(c);
+        auto const call(process
+                        ? process->async().find(args[0u].uint64[0u])
+                        : nullptr);
+        if (!call) {
+            m->logger().error() << "Failed to poll call: invalid handle.";
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+        }
+
+        returnValue->uint64[0u] = call->done() ? 1u : 0u;
+        return SHAREMIND_MODULE_API_0x1_OK;
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    } catch (...) {
+        return SHAREMIND_MODULE_API_0x1_MODULE_ERROR;
+    }
+}
+
+/*
+  tdb_batch_exec takes the data source name as a constant reference and the
+  identifier of a vector map as its argument. Every batch of the vector map
+  describes an operation on the data source by the string vectors "op" and
+  "table" holding the syscall name and the table name, and an optional index
+  vector "args" holding the arguments of the syscall. Access to all operations
+  is checked before any of them is run.
+
+  If the database module implements tdb_batch_exec, the call is forwarded to
+  it as a whole. Otherwise the operations are run one by one until the first
+  failing one. In both cases the syscall returns the identifier of a new vector
+  map, with the index vectors "status" and "result" holding the syscall error
+  code and the first 64 bits of the return value of each operation run.
+*/
+
+struct BatchOperationType {
+    char const * name;
+    DbSyscall syscall;
+
+    /* Access to the table needed, or nullptr for data source access: */
+    char const * permission;
+};
+
+BatchOperationType const batchOperationTypes[] = {
+    { "tdb_tbl_create", DbSyscall_tdb_tbl_create, "write" },
+    { "tdb_tbl_create2", DbSyscall_tdb_tbl_create2, "write" },
+    { "tdb_tbl_delete", DbSyscall_tdb_tbl_delete, "write" },
+    { "tdb_tbl_exists", DbSyscall_tdb_tbl_exists, nullptr },
+    { "tdb_tbl_col_count", DbSyscall_tdb_tbl_col_count, nullptr },
+    { "tdb_tbl_col_names", DbSyscall_tdb_tbl_col_names, nullptr },
+    { "tdb_tbl_col_types", DbSyscall_tdb_tbl_col_types, nullptr },
+    { "tdb_tbl_row_count", DbSyscall_tdb_tbl_row_count, "read" },
+    { "tdb_insert_row", DbSyscall_tdb_insert_row, "write" },
+    { "tdb_insert_row2", DbSyscall_tdb_insert_row2, "write" },
+    { "tdb_read_col", DbSyscall_tdb_read_col, "read" },
+    { "tdb_get_attributes", DbSyscall_tdb_get_attributes, "read" },
+    { "tdb_set_attributes", DbSyscall_tdb_set_attributes, "write" },
+    { "tdb_delete_col", DbSyscall_tdb_delete_col, "write" },
+    { "tdb_delete_row", DbSyscall_tdb_delete_row, "write" },
+    { "tdb_insert_col", DbSyscall_tdb_insert_col, "write" },
+    { "tdb_read_row", DbSyscall_tdb_read_row, "read" },
+    { "tdb_update_col", DbSyscall_tdb_update_col, "write" },
+    { "tdb_update_row", DbSyscall_tdb_update_row, "write" }
+};
+
+struct BatchOperation {
+    BatchOperationType const * type;
+    std::string tblName;
+    std::vector<SharemindCodeBlock> args;
+};
+
+BatchOperationType const * findBatchOperationType(char const * const name)
+        noexcept
+{
+    for (auto const & type : batchOperationTypes)
+        if (!std::strcmp(type.name, name))
+            return &type;
+    return nullptr;
+}
+
+/* Reads the operations from the batches of the vector map: */
+bool readBatchOperations(sharemind::TdbVectorMap & map,
+                         std::vector<BatchOperation> & operations,
+                         LogHard::Logger const & logger)
+{
+    auto const oldBatch = map.currentBatchNumber();
+    try {
+        auto const numBatches = map.batchCount();
+        operations.reserve(numBatches);
+        for (std::size_t i = 0u; i < numBatches; ++i) {
+            map.setBatch(i);
+            auto const & ops = map.getVector<SharemindTdbString>("op");
+            auto const & tbls = map.getVector<SharemindTdbString>("table");
+            if (ops.size() != 1u || tbls.size() != 1u) {
+                logger.error() << "Batch operation " << i << " is not "
+                                  "given a single name and table.";
+                map.setBatch(oldBatch);
+                return false;
+            }
+
+            BatchOperation op;
+            op.type = findBatchOperationType(ops.at(0u).str);
+            if (!op.type) {
+                logger.error() << "Batch operation " << i << " has an "
+                                  "unsupported name: \"" << ops.at(0u).str
+                               << "\".";
+                map.setBatch(oldBatch);
+                return false;
+            }
+            op.tblName = tbls.at(0u).str;
+            if (map.count<SharemindTdbIndex>("args")) {
+                auto const & args = map.getVector<SharemindTdbIndex>("args");
+                op.args.resize(args.size());
+                for (std::size_t j = 0u; j < args.size(); ++j)
+                    op.args[j].uint64[0u] = args.data()[j];
+            }
+            operations.emplace_back(std::move(op));
+        }
+    } catch (...) {
+        map.setBatch(oldBatch);
+        throw;
+    }
+    map.setBatch(oldBatch);
+    return true;
+}
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_batch_exec,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    if (!SyscallArgs<1u, true, 0u, 1u>::check(args, num_args, refs, crefs, returnValue))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    if (!haveNtcsRefs(crefs, 1u))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    sharemind::TdbModule * m = static_cast<sharemind::TdbModule *>(c->moduleHandle);
+
+    try {
+        auto const dsName(refToStringView(crefs[0u]));
+
+        sharemind::TdbVectorMap * const map =
+                m->getVectorMap(c, args[0u].uint64[0u]);
+        if (!map)
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+        std::vector<BatchOperation> operations;
+        if (!readBatchOperations(*map, operations, m->logger()))
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+
+        // Check access to all operations, looking up the facilities once:
+        auto const aclStart(TdbStatistics::Clock::now());
+        TdbProcessContext * process;
+        auto const pr = getProcessContext(*m, c, process);
+        if (pr != SHAREMIND_MODULE_API_0x1_OK)
+            return pr;
+        auto const * aclFacility = process->aclFacility();
+        std::string const & programName = process->programName();
+        TdbAclCache * const aclCache = &process->aclCache();
+        if (!checkPermission(aclCache, *aclFacility, dsName, programName))
+            return SHAREMIND_MODULE_API_0x1_ACCESS_DENIED;
+        for (auto const & op : operations)
+            if (op.type->permission
+                && !checkPermission(aclCache,
+                                    *aclFacility,
+                                    dsName,
+                                    op.tblName,
+                                    op.type->permission,
+                                    programName))
+                return SHAREMIND_MODULE_API_0x1_ACCESS_DENIED;
+        auto const aclTime(TdbStatistics::Clock::now() - aclStart);
+
+        // Let the database module run the whole batch, if it can:
+        std::uint64_t capabilities = 0u;
+        if (!m->getCapabilities(dsName, capabilities)) {
+            m->logger().error() << "Data source \"" << dsName
+                                << "\" is not defined.";
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+        }
+        if (capabilities & SHAREMIND_TDB_CAPABILITY_BATCH_EXEC) {
+            auto const r = m->doSyscall(dsName,
+                                        DbSyscall_tdb_batch_exec,
+                                        aclTime,
+                                        args,
+                                        num_args,
+                                        refs,
+                                        crefs,
+                                        returnValue,
+                                        c);
+            for (auto const & op : operations)
+                m->invalidateTableCache(dsName, op.type->syscall, op.tblName);
+            return r;
+        }
+
+        // Otherwise run the operations one by one:
+        uint64_t resultId;
+        if (!m->newVectorMap(c, resultId))
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+        try {
+            sharemind::TdbVectorMap * const result =
+                    m->getVectorMap(c, resultId);
+            assert(result);
+            auto & status =
+                    result->getOrCreateVector<SharemindTdbIndex>("status");
+            auto & results =
+                    result->getOrCreateVector<SharemindTdbIndex>("result");
+            for (auto & op : operations) {
+                const SharemindModuleApi0x1CReference opCrefs[] = {
+                    crefs[0u],
+                    { op.tblName.c_str(), op.tblName.size() + 1u },
+                    { nullptr, 0u }
+                };
+                SharemindCodeBlock rv;
+                rv.uint64[0u] = 0u;
+                // Access was checked for the whole batch:
+                auto const r = m->doSyscall(dsName,
+                                            op.type->syscall,
+                                            TdbStatistics::Clock::duration::zero(),
+                                            op.args.data(),
+                                            op.args.size(),
+                                            nullptr,
+                                            opCrefs,
+                                            &rv,
+                                            c);
+                status.push_back(SharemindTdbIndex{static_cast<uint64_t>(r)});
+                results.push_back(SharemindTdbIndex{rv.uint64[0u]});
+                if (r != SHAREMIND_MODULE_API_0x1_OK)
+                    break;
+            }
+            result->updateUsage("status");
+            result->updateUsage("result");
+        } catch (...) {
+            m->deleteVectorMap(c, resultId);
+            throw;
+        }
+        returnValue->uint64[0u] = resultId;
+        return SHAREMIND_MODULE_API_0x1_OK;
+    } catch (const sharemind::TdbVectorMap::Exception & e) {
+        m->logger().error() << e.what();
+        return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    } catch (...) {
+        return SHAREMIND_MODULE_API_0x1_MODULE_ERROR;
+    }
+}
+
+/*
+  Returns the bitmap of the optional syscalls the database module of the given
+  data source implements, composed of the SHAREMIND_TDB_CAPABILITY_* bits.
+*/
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_capabilities,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    if (!SyscallArgs<0u, true, 0u, 1u>::check(args, num_args, refs, crefs, returnValue))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    if (!haveNtcsRefs(crefs, 1u))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    try {
+        auto const dsName(refToStringView(crefs[0u]));
+        sharemind::TdbModule & m =
+                *static_cast<sharemind::TdbModule *>(c->moduleHandle);
+
+        TdbProcessContext * process;
+        auto const pr = getProcessContext(m, c, process);
+        if (pr != SHAREMIND_MODULE_API_0x1_OK)
+            return pr;
+        if (!checkPermission(&process->aclCache(),
+                             *process->aclFacility(),
+                             dsName,
+                             process->programName()))
+            return SHAREMIND_MODULE_API_0x1_ACCESS_DENIED;
+
+        std::uint64_t capabilities = 0u;
+        if (!m.getCapabilities(dsName, capabilities)) {
+            m.logger().error() << "Data source \"" << dsName
+                               << "\" is not defined.";
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+        }
+
+        returnValue->uint64[0] = capabilities;
+        return SHAREMIND_MODULE_API_0x1_OK;
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    } catch (...) {
+        return SHAREMIND_MODULE_API_0x1_MODULE_ERROR;
+    }
+}
 
 SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_new,
                                  args, num_args, refs, crefs,
@@ -317,28 +1195,112 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_delete,
     }
 }
 
-SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_size_index,
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_size_index,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    if (!SyscallArgs<1u, true, 0u, 1u>::check(args, num_args, refs, crefs, returnValue))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    if (crefs[0u].size == 0u
+            || static_cast<const char *>(crefs[0u].pData)[crefs[0u].size - 1u] != '\0')
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    sharemind::TdbModule * m = static_cast<sharemind::TdbModule *>(c->moduleHandle);
+
+    try {
+        const uint64_t vmapId = args[0].uint64[0];
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+
+        sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
+        if (!map)
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+
+        returnValue->uint64[0] = map->size<SharemindTdbIndex>(name);
+
+        return SHAREMIND_MODULE_API_0x1_OK;
+    } catch (const sharemind::TdbVectorMap::Exception & e) {
+        m->logger().error() << e.what();
+        return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    } catch (...) {
+        return SHAREMIND_MODULE_API_0x1_MODULE_ERROR;
+    }
+}
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_at_index,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    if (!SyscallArgs<2u, true, 0u, 1u>::check(args, num_args, refs, crefs, returnValue))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    if (crefs[0u].size == 0u
+            || static_cast<const char *>(crefs[0u].pData)[crefs[0u].size - 1u] != '\0')
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    sharemind::TdbModule * m = static_cast<sharemind::TdbModule *>(c->moduleHandle);
+
+    try {
+        const uint64_t vmapId = args[0].uint64[0];
+        const uint64_t num = args[1].uint64[0];
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+
+        sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
+        if (!map)
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+
+        const SharemindTdbIndex & idx = map->at<SharemindTdbIndex>(name, num);
+
+        returnValue->uint64[0] = idx.idx;
+
+        return SHAREMIND_MODULE_API_0x1_OK;
+    } catch (const sharemind::TdbVectorMap::Exception & e) {
+        m->logger().error() << e.what();
+        return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    } catch (...) {
+        return SHAREMIND_MODULE_API_0x1_MODULE_ERROR;
+    }
+}
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_read_index_vector,
                                  args, num_args, refs, crefs,
                                  returnValue, c)
 {
-    if (!SyscallArgs<1u, true, 0u, 1u>::check(args, num_args, refs, crefs, returnValue))
+    if (!SyscallArgs<3u, false, 1u, 1u>::check(args, num_args, refs, crefs, returnValue))
         return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
 
     if (crefs[0u].size == 0u
             || static_cast<const char *>(crefs[0u].pData)[crefs[0u].size - 1u] != '\0')
         return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
 
+    const uint64_t count = args[2u].uint64[0];
+    if (count > refs[0u].size / sizeof(uint64_t))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
     sharemind::TdbModule * m = static_cast<sharemind::TdbModule *>(c->moduleHandle);
 
     try {
-        const uint64_t vmapId = args[0].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const uint64_t vmapId = args[0u].uint64[0];
+        const uint64_t offset = args[1u].uint64[0];
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
             return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
 
-        returnValue->uint64[0] = map->size<SharemindTdbIndex>(name);
+        auto const & vec = map->getVector<SharemindTdbIndex>(name);
+        if (offset > vec.size() || count > vec.size() - offset) {
+            m->logger().error() << "Failed to read \"" << name
+                                << "\": range out of bounds.";
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+        }
+
+        if (count)
+            memcpy(refs[0u].pData, vec.data() + offset, count * sizeof(uint64_t));
 
         return SHAREMIND_MODULE_API_0x1_OK;
     } catch (const sharemind::TdbVectorMap::Exception & e) {
@@ -351,11 +1313,11 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_size_index,
     }
 }
 
-SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_at_index,
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_push_back_index,
                                  args, num_args, refs, crefs,
                                  returnValue, c)
 {
-    if (!SyscallArgs<2u, true, 0u, 1u>::check(args, num_args, refs, crefs, returnValue))
+    if (!SyscallArgs<2u, false, 0u, 1u>::check(args, num_args, refs, crefs, returnValue))
         return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
 
     if (crefs[0u].size == 0u
@@ -366,18 +1328,22 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_at_index,
 
     try {
         const uint64_t vmapId = args[0].uint64[0];
-        const uint64_t num = args[1].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const uint64_t val = args[1].uint64[0];
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
             return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
 
-        const SharemindTdbIndex & idx = map->at<SharemindTdbIndex>(name, num);
-
-        returnValue->uint64[0] = idx.idx;
+        map->checkQuota(map->appendBytes<SharemindTdbIndex>(name, 1u, sizeof(SharemindTdbIndex)));
+        map->getOrCreateVector<SharemindTdbIndex>(name).push_back(
+                    SharemindTdbIndex{val});
+        map->updateUsage(name);
 
         return SHAREMIND_MODULE_API_0x1_OK;
+    } catch (const sharemind::TdbVectorMap::QuotaException & e) {
+        m->logger().error() << e.what();
+        return SHAREMIND_MODULE_API_0x1_IMPLEMENTATION_LIMITS_REACHED;
     } catch (const sharemind::TdbVectorMap::Exception & e) {
         m->logger().error() << e.what();
         return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
@@ -388,37 +1354,41 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_at_index,
     }
 }
 
-SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_push_back_index,
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_push_back_index_vector,
                                  args, num_args, refs, crefs,
                                  returnValue, c)
 {
-    if (!SyscallArgs<2u, false, 0u, 1u>::check(args, num_args, refs, crefs, returnValue))
+    if (!SyscallArgs<2u, false, 0u, 2u>::check(args, num_args, refs, crefs, returnValue))
         return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
 
     if (crefs[0u].size == 0u
             || static_cast<const char *>(crefs[0u].pData)[crefs[0u].size - 1u] != '\0')
         return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
 
+    const uint64_t count = args[1].uint64[0];
+    if (count > crefs[1u].size / sizeof(uint64_t))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
     sharemind::TdbModule * m = static_cast<sharemind::TdbModule *>(c->moduleHandle);
 
     try {
         const uint64_t vmapId = args[0].uint64[0];
-        const uint64_t val = args[1].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
             return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
 
-        SharemindTdbIndex * idx = SharemindTdbIndex_new(val);
-        try {
-            map->push_back<SharemindTdbIndex>(name, idx);
-        } catch (...) {
-            SharemindTdbIndex_delete(idx);
-            throw;
-        }
+        map->checkQuota(map->appendBytes<SharemindTdbIndex>(name, count, count * sizeof(SharemindTdbIndex)));
+        map->getOrCreateVector<SharemindTdbIndex>(name).append(
+                    static_cast<const uint64_t *>(crefs[1u].pData),
+                    count);
+        map->updateUsage(name);
 
         return SHAREMIND_MODULE_API_0x1_OK;
+    } catch (const sharemind::TdbVectorMap::QuotaException & e) {
+        m->logger().error() << e.what();
+        return SHAREMIND_MODULE_API_0x1_IMPLEMENTATION_LIMITS_REACHED;
     } catch (const sharemind::TdbVectorMap::Exception & e) {
         m->logger().error() << e.what();
         return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
@@ -444,7 +1414,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_pop_back_index,
 
     try {
         const uint64_t vmapId = args[0].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -478,7 +1448,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_clear_index,
 
     try {
         const uint64_t vmapId = args[0].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -512,7 +1482,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_is_index_vector,
 
     try {
         const uint64_t vmapId = args[0].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -546,7 +1516,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_size_string,
 
     try {
         const uint64_t vmapId = args[0].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -581,7 +1551,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_at_string,
     try {
         const uint64_t vmapId = args[0u].uint64[0u];
         const uint64_t num = args[1u].uint64[0u];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -606,6 +1576,76 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_at_string,
     }
 }
 
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_read_string_vector,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    /*
+      Called with no references this only returns the number of bytes the
+      payloads in the range take. Called with two references refs[0]
+      receives the payloads back to back and refs[1] the count + 1 offsets
+      of the payloads in it.
+    */
+    const bool sizeQuery = SyscallArgs<3u, true, 0u, 1u>::check(args, num_args, refs, crefs, returnValue);
+    if (!sizeQuery && !SyscallArgs<3u, true, 2u, 1u>::check(args, num_args, refs, crefs, returnValue))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    if (crefs[0u].size == 0u
+            || static_cast<const char *>(crefs[0u].pData)[crefs[0u].size - 1u] != '\0')
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    const uint64_t count = args[2u].uint64[0];
+    if (!sizeQuery && count >= refs[1u].size / sizeof(uint64_t))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    sharemind::TdbModule * m = static_cast<sharemind::TdbModule *>(c->moduleHandle);
+
+    try {
+        const uint64_t vmapId = args[0u].uint64[0];
+        const uint64_t offset = args[1u].uint64[0];
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+
+        sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
+        if (!map)
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+
+        auto const & vec = map->getVector<SharemindTdbString>(name);
+        if (offset > vec.size() || count > vec.size() - offset) {
+            m->logger().error() << "Failed to read \"" << name
+                                << "\": range out of bounds.";
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+        }
+
+        // The strings are stored back to back including their terminators:
+        const uint64_t * const offsets = vec.offsets() + offset;
+        const uint64_t bytes = offsets[count] - offsets[0u];
+
+        if (!sizeQuery) {
+            if (bytes > refs[0u].size)
+                return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+            if (bytes)
+                memcpy(refs[0u].pData, vec.data() + offsets[0u], bytes);
+            uint64_t * const outOffsets = static_cast<uint64_t *>(refs[1u].pData);
+            for (uint64_t i = 0u; i <= count; ++i) {
+                const uint64_t pos = offsets[i] - offsets[0u];
+                memcpy(&outOffsets[i], &pos, sizeof(uint64_t));
+            }
+        }
+
+        returnValue->uint64[0] = bytes;
+
+        return SHAREMIND_MODULE_API_0x1_OK;
+    } catch (const sharemind::TdbVectorMap::Exception & e) {
+        m->logger().error() << e.what();
+        return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    } catch (...) {
+        return SHAREMIND_MODULE_API_0x1_MODULE_ERROR;
+    }
+}
+
 SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_push_back_string,
                                  args, num_args, refs, crefs,
                                  returnValue, c)
@@ -623,22 +1663,22 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_push_back_string,
 
     try {
         const uint64_t vmapId = args[0].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
-        const std::string str(static_cast<const char *>(crefs[1u].pData), crefs[1u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
             return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
 
-        auto * const s = SharemindTdbString_new2(str.c_str(), str.size());
-        try {
-            map->push_back<SharemindTdbString>(name, s);
-        } catch (...) {
-            SharemindTdbString_delete(s);
-            throw;
-        }
+        map->checkQuota(map->appendBytes<SharemindTdbString>(name, 1u, crefs[1u].size));
+        map->getOrCreateVector<SharemindTdbString>(name).push_back(
+                    static_cast<const char *>(crefs[1u].pData),
+                    crefs[1u].size - 1u);
+        map->updateUsage(name);
 
         return SHAREMIND_MODULE_API_0x1_OK;
+    } catch (const sharemind::TdbVectorMap::QuotaException & e) {
+        m->logger().error() << e.what();
+        return SHAREMIND_MODULE_API_0x1_IMPLEMENTATION_LIMITS_REACHED;
     } catch (const sharemind::TdbVectorMap::Exception & e) {
         m->logger().error() << e.what();
         return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
@@ -664,7 +1704,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_pop_back_string,
 
     try {
         const uint64_t vmapId = args[0].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -698,7 +1738,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_clear_string,
 
     try {
         const uint64_t vmapId = args[0].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -732,7 +1772,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_is_string_vector,
 
     try {
         const uint64_t vmapId = args[0].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -766,7 +1806,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_size_type,
 
     try {
         const uint64_t vmapId = args[0].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -801,7 +1841,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_at_type_domain,
     try {
         const uint64_t vmapId = args[0].uint64[0];
         const uint64_t num = args[1].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -843,7 +1883,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_at_type_name,
     try {
         const uint64_t vmapId = args[0].uint64[0];
         const uint64_t num = args[1].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -885,7 +1925,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_at_type_size,
     try {
         const uint64_t vmapId = args[0].uint64[0];
         const uint64_t num = args[1].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -925,27 +1965,25 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_push_back_type,
     try {
         const uint64_t vmapId = args[0].uint64[0];
         const uint64_t typeSize = args[1].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
             return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
 
-        auto * const t =
-                SharemindTdbType_new2(
+        map->checkQuota(map->appendBytes<SharemindTdbType>(name, 1u, crefs[1u].size + crefs[2u].size));
+        map->getOrCreateVector<SharemindTdbType>(name).push_back(
                     static_cast<const char *>(crefs[1u].pData),
                     crefs[1u].size - 1u,
                     static_cast<const char *>(crefs[2u].pData),
                     crefs[2u].size - 1u,
                     typeSize);
-        try {
-            map->push_back<SharemindTdbType>(name, t);
-        } catch (...) {
-            SharemindTdbType_delete(t);
-            throw;
-        }
+        map->updateUsage(name);
 
         return SHAREMIND_MODULE_API_0x1_OK;
+    } catch (const sharemind::TdbVectorMap::QuotaException & e) {
+        m->logger().error() << e.what();
+        return SHAREMIND_MODULE_API_0x1_IMPLEMENTATION_LIMITS_REACHED;
     } catch (const sharemind::TdbVectorMap::Exception & e) {
         m->logger().error() << e.what();
         return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
@@ -971,7 +2009,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_pop_back_type,
 
     try {
         const uint64_t vmapId = args[0].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -1005,7 +2043,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_clear_type,
 
     try {
         const uint64_t vmapId = args[0].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -1039,7 +2077,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_is_type_vector,
 
     try {
         const uint64_t vmapId = args[0].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -1073,7 +2111,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_size_value,
 
     try {
         const uint64_t vmapId = args[0].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -1108,7 +2146,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_at_value_type_domain,
     try {
         const uint64_t vmapId = args[0].uint64[0];
         const uint64_t num = args[1].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -1150,7 +2188,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_at_value_type_name,
     try {
         const uint64_t vmapId = args[0].uint64[0];
         const uint64_t num = args[1].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -1192,7 +2230,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_at_value_type_size,
     try {
         const uint64_t vmapId = args[0].uint64[0];
         const uint64_t num = args[1].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -1237,7 +2275,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_at_value,
     try {
         const uint64_t vmapId = args[0].uint64[0];
         const uint64_t num = args[1].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -1271,6 +2309,77 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_at_value,
     }
 }
 
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_read_value_vector,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    /*
+      Called with no references this only returns the number of bytes the
+      payloads in the range take. Called with two references refs[0]
+      receives the payloads back to back and refs[1] the count + 1 offsets
+      of the payloads in it.
+    */
+    const bool sizeQuery = SyscallArgs<3u, true, 0u, 1u>::check(args, num_args, refs, crefs, returnValue);
+    if (!sizeQuery && !SyscallArgs<3u, true, 2u, 1u>::check(args, num_args, refs, crefs, returnValue))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    if (crefs[0u].size == 0u
+            || static_cast<const char *>(crefs[0u].pData)[crefs[0u].size - 1u] != '\0')
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    const uint64_t count = args[2u].uint64[0];
+    if (!sizeQuery && count >= refs[1u].size / sizeof(uint64_t))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    sharemind::TdbModule * m = static_cast<sharemind::TdbModule *>(c->moduleHandle);
+
+    try {
+        const uint64_t vmapId = args[0u].uint64[0];
+        const uint64_t offset = args[1u].uint64[0];
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+
+        sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
+        if (!map)
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+
+        auto const & vec = map->getVector<SharemindTdbValue>(name);
+        if (offset > vec.size() || count > vec.size() - offset) {
+            m->logger().error() << "Failed to read \"" << name
+                                << "\": range out of bounds.";
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+        }
+
+        const uint64_t * const offsets = vec.offsets() + offset;
+        const uint64_t bytes = offsets[count] - offsets[0u];
+
+        if (!sizeQuery) {
+            // The buffer only has to be at least bytes long:
+            if (bytes > refs[0u].size)
+                return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+            if (bytes)
+                memcpy(refs[0u].pData, vec.payload() + offsets[0u], bytes);
+
+            uint64_t * const outOffsets = static_cast<uint64_t *>(refs[1u].pData);
+            for (uint64_t i = 0u; i <= count; ++i) {
+                const uint64_t pos = offsets[i] - offsets[0u];
+                memcpy(&outOffsets[i], &pos, sizeof(uint64_t));
+            }
+        }
+
+        returnValue->uint64[0] = bytes;
+
+        return SHAREMIND_MODULE_API_0x1_OK;
+    } catch (const sharemind::TdbVectorMap::Exception & e) {
+        m->logger().error() << e.what();
+        return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    } catch (...) {
+        return SHAREMIND_MODULE_API_0x1_MODULE_ERROR;
+    }
+}
+
 SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_push_back_value,
                                  args, num_args, refs, crefs,
                                  returnValue, c)
@@ -1293,7 +2402,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_push_back_value,
         const uint64_t vmapId = args[0].uint64[0];
         const uint64_t typeSize = args[1].uint64[0];
         const bool isScalar = static_cast<bool>(args[2u].uint8[0]);
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         uint64_t bufSize = 0;
 
@@ -1309,24 +2418,81 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_push_back_value,
         if (!map)
             return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
 
-        auto * const v =
-                SharemindTdbValue_new2(
-                    static_cast<const char *>(crefs[1u].pData),
-                    crefs[1u].size - 1u,
-                    static_cast<const char *>(crefs[2u].pData),
-                    crefs[2u].size - 1u,
-                    typeSize,
+        // The type is only copied if the vector has no equal type yet:
+        const SharemindTdbType type{
+                const_cast<char *>(static_cast<const char *>(crefs[1u].pData)),
+                const_cast<char *>(static_cast<const char *>(crefs[2u].pData)),
+                typeSize};
+        map->checkQuota(map->appendBytes<SharemindTdbValue>(name, 1u, bufSize));
+        map->getOrCreateVector<SharemindTdbValue>(name).append(
+                    type,
                     bufSize ? crefs[3u].pData : nullptr,
+                    1u,
                     bufSize);
+        map->updateUsage(name);
 
-        try {
-            map->push_back<SharemindTdbValue>(name, v);
-        } catch (...) {
-            SharemindTdbValue_delete(v);
-            throw;
-        }
+        return SHAREMIND_MODULE_API_0x1_OK;
+    } catch (const sharemind::TdbVectorMap::QuotaException & e) {
+        m->logger().error() << e.what();
+        return SHAREMIND_MODULE_API_0x1_IMPLEMENTATION_LIMITS_REACHED;
+    } catch (const sharemind::TdbVectorMap::Exception & e) {
+        m->logger().error() << e.what();
+        return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    } catch (...) {
+        return SHAREMIND_MODULE_API_0x1_MODULE_ERROR;
+    }
+}
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_push_back_value_vector,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    if (!SyscallArgs<4u, false, 0u, 4u>::check(args, num_args, refs, crefs, returnValue))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    if (crefs[0u].size == 0u
+            || crefs[1u].size == 0u
+            || crefs[2u].size == 0u
+            || static_cast<const char *>(crefs[0u].pData)[crefs[0u].size - 1u] != '\0'
+            || static_cast<const char *>(crefs[1u].pData)[crefs[1u].size - 1u] != '\0'
+            || static_cast<const char *>(crefs[2u].pData)[crefs[2u].size - 1u] != '\0')
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    // The buffer holds count values of elemSize bytes each:
+    const uint64_t count = args[2u].uint64[0];
+    const uint64_t elemSize = args[3u].uint64[0];
+    if (elemSize != 0u && count > crefs[3u].size / elemSize)
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    sharemind::TdbModule * m = static_cast<sharemind::TdbModule *>(c->moduleHandle);
+
+    try {
+        const uint64_t vmapId = args[0].uint64[0];
+        const uint64_t typeSize = args[1].uint64[0];
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+
+        sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
+        if (!map)
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+
+        const SharemindTdbType type{
+                const_cast<char *>(static_cast<const char *>(crefs[1u].pData)),
+                const_cast<char *>(static_cast<const char *>(crefs[2u].pData)),
+                typeSize};
+        map->checkQuota(map->appendBytes<SharemindTdbValue>(name, count, count * elemSize));
+        map->getOrCreateVector<SharemindTdbValue>(name).append(
+                    type,
+                    crefs[3u].pData,
+                    count,
+                    elemSize);
+        map->updateUsage(name);
 
         return SHAREMIND_MODULE_API_0x1_OK;
+    } catch (const sharemind::TdbVectorMap::QuotaException & e) {
+        m->logger().error() << e.what();
+        return SHAREMIND_MODULE_API_0x1_IMPLEMENTATION_LIMITS_REACHED;
     } catch (const sharemind::TdbVectorMap::Exception & e) {
         m->logger().error() << e.what();
         return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
@@ -1352,7 +2518,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_pop_back_value,
 
     try {
         const uint64_t vmapId = args[0].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -1386,7 +2552,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_clear_value,
 
     try {
         const uint64_t vmapId = args[0].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -1420,7 +2586,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_is_value_vector,
 
     try {
         const uint64_t vmapId = args[0].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -1454,7 +2620,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_count,
 
     try {
         const uint64_t vmapId = args[0].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -1494,7 +2660,7 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_erase,
 
     try {
         const uint64_t vmapId = args[0].uint64[0];
-        const std::string name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
 
         sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
         if (!map)
@@ -1662,6 +2828,127 @@ SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_batch_count,
     }
 }
 
+/*
+  tdb_vmap_memory_usage returns the number of bytes held by all vector maps of
+  the process, which is limited by the VectorMaps.MemoryQuota setting. Calls
+  growing a vector map beyond the quota fail with IMPLEMENTATION_LIMITS_REACHED
+  rather than OUT_OF_MEMORY, so that programs can tell an exhausted quota from
+  a failed allocation. The per data source error store read by tdb_error_code
+  is left to the database modules, as vector maps belong to no data source.
+  Database modules storing vectors over the quota get QUOTA_EXCEEDED from the
+  vector map interface.
+*/
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_memory_usage,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    if (!SyscallArgs<0u, true, 0u, 0u>::check(args, num_args, refs, crefs, returnValue))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    sharemind::TdbModule * m = static_cast<sharemind::TdbModule *>(c->moduleHandle);
+
+    uint64_t bytes;
+    if (!m->vectorMapMemoryUsage(c, bytes))
+        return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+
+    returnValue->uint64[0] = bytes;
+
+    return SHAREMIND_MODULE_API_0x1_OK;
+}
+
+/*
+  tdb_vmap_save writes the contents of a vector map to the named snapshot file
+  in the directory given by the VectorMaps.SnapshotDirectory setting, and
+  tdb_vmap_load creates a new vector map from such a snapshot. Snapshots are
+  disabled unless the directory is set.
+*/
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_save,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    if (!SyscallArgs<1u, false, 0u, 1u>::check(args, num_args, refs, crefs, returnValue))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    if (crefs[0u].size == 0u
+            || static_cast<const char *>(crefs[0u].pData)[crefs[0u].size - 1u] != '\0')
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    sharemind::TdbModule * m = static_cast<sharemind::TdbModule *>(c->moduleHandle);
+
+    try {
+        const uint64_t vmapId = args[0].uint64[0];
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+
+        std::string path;
+        if (!m->vectorMapSnapshotPath(name, path))
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+
+        sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
+        if (!map)
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+
+        sharemind::TdbVectorMapSnapshot::save(*map, path);
+
+        return SHAREMIND_MODULE_API_0x1_OK;
+    } catch (const sharemind::TdbVectorMap::Exception & e) {
+        m->logger().error() << e.what();
+        return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    } catch (...) {
+        return SHAREMIND_MODULE_API_0x1_MODULE_ERROR;
+    }
+}
+
+SHAREMIND_MODULE_API_0x1_SYSCALL(tdb_vmap_load,
+                                 args, num_args, refs, crefs,
+                                 returnValue, c)
+{
+    if (!SyscallArgs<0u, true, 0u, 1u>::check(args, num_args, refs, crefs, returnValue))
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    if (crefs[0u].size == 0u
+            || static_cast<const char *>(crefs[0u].pData)[crefs[0u].size - 1u] != '\0')
+        return SHAREMIND_MODULE_API_0x1_INVALID_CALL;
+
+    sharemind::TdbModule * m = static_cast<sharemind::TdbModule *>(c->moduleHandle);
+
+    try {
+        const boost::string_view name(static_cast<const char *>(crefs[0u].pData), crefs[0u].size - 1u);
+
+        std::string path;
+        if (!m->vectorMapSnapshotPath(name, path))
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+
+        uint64_t vmapId = 0;
+        if (!m->newVectorMap(c, vmapId))
+            return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+
+        try {
+            sharemind::TdbVectorMap * map = m->getVectorMap(c, vmapId);
+            assert(map);
+            sharemind::TdbVectorMapSnapshot::load(path, *map);
+        } catch (...) {
+            m->deleteVectorMap(c, vmapId);
+            throw;
+        }
+
+        returnValue->uint64[0] = vmapId;
+
+        return SHAREMIND_MODULE_API_0x1_OK;
+    } catch (const sharemind::TdbVectorMap::QuotaException & e) {
+        m->logger().error() << e.what();
+        return SHAREMIND_MODULE_API_0x1_IMPLEMENTATION_LIMITS_REACHED;
+    } catch (const sharemind::TdbVectorMap::Exception & e) {
+        m->logger().error() << e.what();
+        return SHAREMIND_MODULE_API_0x1_GENERAL_ERROR;
+    } catch (const std::bad_alloc &) {
+        return SHAREMIND_MODULE_API_0x1_OUT_OF_MEMORY;
+    } catch (...) {
+        return SHAREMIND_MODULE_API_0x1_MODULE_ERROR;
+    }
+}
+
 } /* namespace { */
 
 extern "C" {
@@ -1712,28 +2999,32 @@ SHAREMIND_MODULE_API_0x1_INITIALIZER(c) {
                         c->conf,
                         // List of required submodule syscall signatures:
                         std::vector<std::string>{
-                            "tdb_open",
-                            "tdb_close",
-                            "tdb_table_names",
-                            "tdb_tbl_create",
-                            "tdb_tbl_create2",
-                            "tdb_tbl_delete",
-                            "tdb_tbl_exists",
-                            "tdb_tbl_col_count",
-                            "tdb_tbl_col_names",
-                            "tdb_tbl_col_types",
-                            "tdb_tbl_row_count",
-                            // "tdb_delete_col",
-                            // "tdb_delete_row",
-                            // "tdb_insert_col",
-                            "tdb_insert_row",
-                            "tdb_insert_row2",
-                            "tdb_read_col",
-                            "tdb_get_attributes",
-                            "tdb_set_attributes",
-                            // "tdb_read_row",
-                            // "tdb_update_col",
-                            // "tdb_update_row"
+                            #define MOD_TABLEDB_DB_SYSCALL_SIGNATURE(name) \
+                                #name,
+                            MOD_TABLEDB_DB_SYSCALLS(
+                                    MOD_TABLEDB_DB_SYSCALL_SIGNATURE)
+                        },
+                        // List of optional submodule syscall signatures:
+                        std::vector<std::string>{
+                            MOD_TABLEDB_OPTIONAL_DB_SYSCALLS(
+                                    MOD_TABLEDB_DB_SYSCALL_SIGNATURE)
+                            #undef MOD_TABLEDB_DB_SYSCALL_SIGNATURE
+                        },
+                        // Names of the instrumented syscalls:
+                        std::vector<std::string>{
+                            #define MOD_TABLEDB_SYSCALL_NAME(name) #name,
+                            MOD_TABLEDB_SYSCALLS(MOD_TABLEDB_SYSCALL_NAME)
+                            #undef MOD_TABLEDB_SYSCALL_NAME
+                        },
+                        // Table cache uses of the submodule syscalls:
+                        std::vector<TdbTableCache::Use>{
+                            #define MOD_TABLEDB_DB_SYSCALL_CACHE_USE(name) \
+                                tableCacheUse(DbSyscall_ ## name),
+                            MOD_TABLEDB_DB_SYSCALLS(
+                                    MOD_TABLEDB_DB_SYSCALL_CACHE_USE)
+                            MOD_TABLEDB_OPTIONAL_DB_SYSCALLS(
+                                    MOD_TABLEDB_DB_SYSCALL_CACHE_USE)
+                            #undef MOD_TABLEDB_DB_SYSCALL_CACHE_USE
                         });
         } catch (...) {
             logger.printCurrentException();
@@ -1760,81 +3051,109 @@ SHAREMIND_MODULE_API_0x1_DEINITIALIZER(c) {
     c->moduleHandle = nullptr;
 }
 
+#define MOD_TABLEDB_SYSCALL(name) \
+    { #name, &instrumentedSyscall<&name, Syscall_ ## name> }
+
 SHAREMIND_MODULE_API_0x1_SYSCALL_DEFINITIONS(
 
     /* Error handling */
-      { "tdb_error_code",                   &tdb_error_code }
+      MOD_TABLEDB_SYSCALL(tdb_error_code)
 
     /* High level database operations */
-    , { "tdb_open",                         &tdb_open }
-    , { "tdb_close",                        &tdb_close }
-    , { "tdb_table_names",                  &tdb_table_names }
+    , MOD_TABLEDB_SYSCALL(tdb_open)
+    , MOD_TABLEDB_SYSCALL(tdb_close)
+    , MOD_TABLEDB_SYSCALL(tdb_table_names)
+    , MOD_TABLEDB_SYSCALL(tdb_capabilities)
 
     /* Table database API */
-    , { "tdb_tbl_create",                   &tdb_tbl_create }
-    , { "tdb_tbl_create2",                  &tdb_tbl_create2 }
-    , { "tdb_tbl_delete",                   &tdb_tbl_delete }
-    , { "tdb_tbl_exists",                   &tdb_tbl_exists }
-    , { "tdb_tbl_col_count",                &tdb_tbl_col_count }
-    , { "tdb_tbl_col_names",                &tdb_tbl_col_names }
-    , { "tdb_tbl_col_types",                &tdb_tbl_col_types }
-    , { "tdb_tbl_row_count",                &tdb_tbl_row_count }
-    //, { "tdb_delete_col", &tdb_delete_col }
-    //, { "tdb_delete_row", &tdb_delete_row }
-    //, { "tdb_insert_col", &tdb_insert_col }
-    , { "tdb_insert_row",                   &tdb_insert_row }
-    , { "tdb_insert_row2",                  &tdb_insert_row2 }
-    , { "tdb_read_col",                     &tdb_read_col }
-    //, { "tdb_read_row",   &tdb_read_row }
-    //, { "tdb_update_col", &tdb_update_col }
-    //, { "tdb_update_row", &tdb_update_row }
-    , { "tdb_get_attributes",               &tdb_get_attributes }
-    , { "tdb_set_attributes",               &tdb_set_attributes }
+    , MOD_TABLEDB_SYSCALL(tdb_tbl_create)
+    , MOD_TABLEDB_SYSCALL(tdb_tbl_create2)
+    , MOD_TABLEDB_SYSCALL(tdb_tbl_delete)
+    , MOD_TABLEDB_SYSCALL(tdb_tbl_exists)
+    , MOD_TABLEDB_SYSCALL(tdb_tbl_col_count)
+    , MOD_TABLEDB_SYSCALL(tdb_tbl_col_names)
+    , MOD_TABLEDB_SYSCALL(tdb_tbl_col_types)
+    , MOD_TABLEDB_SYSCALL(tdb_tbl_row_count)
+    , MOD_TABLEDB_SYSCALL(tdb_delete_col)
+    , MOD_TABLEDB_SYSCALL(tdb_delete_row)
+    , MOD_TABLEDB_SYSCALL(tdb_insert_col)
+    , MOD_TABLEDB_SYSCALL(tdb_insert_row)
+    , MOD_TABLEDB_SYSCALL(tdb_insert_row2)
+    , MOD_TABLEDB_SYSCALL(tdb_read_col)
+    , MOD_TABLEDB_SYSCALL(tdb_read_col_open)
+    , MOD_TABLEDB_SYSCALL(tdb_read_col_next)
+    , MOD_TABLEDB_SYSCALL(tdb_read_col_close)
+    , MOD_TABLEDB_SYSCALL(tdb_read_row)
+    , MOD_TABLEDB_SYSCALL(tdb_update_col)
+    , MOD_TABLEDB_SYSCALL(tdb_update_row)
+    , MOD_TABLEDB_SYSCALL(tdb_get_attributes)
+    , MOD_TABLEDB_SYSCALL(tdb_set_attributes)
+
+    /* Asynchronous database operations */
+    , MOD_TABLEDB_SYSCALL(tdb_insert_row_async)
+    , MOD_TABLEDB_SYSCALL(tdb_read_col_async)
+    , MOD_TABLEDB_SYSCALL(tdb_wait)
+    , MOD_TABLEDB_SYSCALL(tdb_poll)
+
+    /* Batched database operations */
+    , MOD_TABLEDB_SYSCALL(tdb_batch_exec)
 
     /* Parameter and result vector map API */
     /* Constructor/Destructor */
-    , { "tdb_vmap_new",                     &tdb_vmap_new }
-    , { "tdb_vmap_delete",                  &tdb_vmap_delete }
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_new)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_delete)
 
     /* Value manipulation */
-    , { "tdb_vmap_size_index",              &tdb_vmap_size_index }
-    , { "tdb_vmap_at_index",                &tdb_vmap_at_index }
-    , { "tdb_vmap_push_back_index",         &tdb_vmap_push_back_index }
-    , { "tdb_vmap_pop_back_index",          &tdb_vmap_pop_back_index }
-    , { "tdb_vmap_clear_index",             &tdb_vmap_clear_index }
-    , { "tdb_vmap_is_index_vector",         &tdb_vmap_is_index_vector }
-    , { "tdb_vmap_size_string",             &tdb_vmap_size_string }
-    , { "tdb_vmap_at_string",               &tdb_vmap_at_string }
-    , { "tdb_vmap_push_back_string",        &tdb_vmap_push_back_string }
-    , { "tdb_vmap_pop_back_string",         &tdb_vmap_pop_back_string }
-    , { "tdb_vmap_clear_string",            &tdb_vmap_clear_string }
-    , { "tdb_vmap_is_string_vector",        &tdb_vmap_is_string_vector }
-    , { "tdb_vmap_size_type",               &tdb_vmap_size_type }
-    , { "tdb_vmap_at_type_domain",          &tdb_vmap_at_type_domain }
-    , { "tdb_vmap_at_type_name",            &tdb_vmap_at_type_name }
-    , { "tdb_vmap_at_type_size",            &tdb_vmap_at_type_size }
-    , { "tdb_vmap_push_back_type",          &tdb_vmap_push_back_type }
-    , { "tdb_vmap_pop_back_type",           &tdb_vmap_pop_back_type }
-    , { "tdb_vmap_clear_type",              &tdb_vmap_clear_type }
-    , { "tdb_vmap_is_type_vector",          &tdb_vmap_is_type_vector }
-    , { "tdb_vmap_size_value",              &tdb_vmap_size_value }
-    , { "tdb_vmap_at_value_type_domain",    &tdb_vmap_at_value_type_domain }
-    , { "tdb_vmap_at_value_type_name",      &tdb_vmap_at_value_type_name }
-    , { "tdb_vmap_at_value_type_size",      &tdb_vmap_at_value_type_size }
-    , { "tdb_vmap_at_value",                &tdb_vmap_at_value }
-    , { "tdb_vmap_push_back_value",         &tdb_vmap_push_back_value }
-    , { "tdb_vmap_pop_back_value",          &tdb_vmap_pop_back_value }
-    , { "tdb_vmap_clear_value",             &tdb_vmap_clear_value }
-    , { "tdb_vmap_is_value_vector",         &tdb_vmap_is_value_vector }
-    , { "tdb_vmap_count",                   &tdb_vmap_count }
-    , { "tdb_vmap_erase",                   &tdb_vmap_erase }
-    , { "tdb_vmap_clear",                   &tdb_vmap_clear }
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_size_index)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_at_index)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_read_index_vector)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_push_back_index)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_push_back_index_vector)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_pop_back_index)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_clear_index)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_is_index_vector)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_size_string)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_at_string)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_read_string_vector)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_push_back_string)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_pop_back_string)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_clear_string)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_is_string_vector)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_size_type)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_at_type_domain)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_at_type_name)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_at_type_size)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_push_back_type)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_pop_back_type)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_clear_type)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_is_type_vector)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_size_value)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_at_value_type_domain)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_at_value_type_name)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_at_value_type_size)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_at_value)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_read_value_vector)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_push_back_value)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_push_back_value_vector)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_pop_back_value)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_clear_value)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_is_value_vector)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_count)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_erase)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_clear)
 
     /* Batch manipulation */
-    , { "tdb_vmap_reset",                   &tdb_vmap_reset }
-    , { "tdb_vmap_set_batch",               &tdb_vmap_set_batch }
-    , { "tdb_vmap_add_batch",               &tdb_vmap_add_batch }
-    , { "tdb_vmap_batch_count",             &tdb_vmap_batch_count }
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_reset)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_set_batch)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_add_batch)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_batch_count)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_memory_usage)
+
+    /* Snapshots */
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_save)
+    , MOD_TABLEDB_SYSCALL(tdb_vmap_load)
 );
 
+#undef MOD_TABLEDB_SYSCALL
+
 } /* extern "C" { */
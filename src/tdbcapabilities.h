@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SHAREMIND_MOD_TABLEDB_TDBCAPABILITIES_H
+#define SHAREMIND_MOD_TABLEDB_TDBCAPABILITIES_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+  Bits of the capability bitmap returned by the tdb_capabilities syscall. Each
+  bit is set if the database module of the data source implements the given
+  optional syscall.
+*/
+enum SharemindTdbCapability_ {
+
+    SHAREMIND_TDB_CAPABILITY_DELETE_COL     = 0x001,
+    SHAREMIND_TDB_CAPABILITY_DELETE_ROW     = 0x002,
+    SHAREMIND_TDB_CAPABILITY_INSERT_COL     = 0x004,
+    SHAREMIND_TDB_CAPABILITY_READ_ROW       = 0x008,
+    SHAREMIND_TDB_CAPABILITY_UPDATE_COL     = 0x010,
+    SHAREMIND_TDB_CAPABILITY_UPDATE_ROW     = 0x020,
+
+    /** tdb_read_col_open, tdb_read_col_next and tdb_read_col_close. */
+    SHAREMIND_TDB_CAPABILITY_READ_COL_OPEN  = 0x040,
+    SHAREMIND_TDB_CAPABILITY_READ_COL_NEXT  = 0x080,
+    SHAREMIND_TDB_CAPABILITY_READ_COL_CLOSE = 0x100,
+
+    /** The database module executes tdb_batch_exec envelopes itself. */
+    SHAREMIND_TDB_CAPABILITY_BATCH_EXEC     = 0x200
+
+};
+typedef enum SharemindTdbCapability_ SharemindTdbCapability;
+
+#ifdef __cplusplus
+} /* extern "C" { */
+#endif
+
+#endif /* SHAREMIND_MOD_TABLEDB_TDBCAPABILITIES_H */
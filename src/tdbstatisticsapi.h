@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SHAREMIND_MOD_TABLEDB_TDBSTATISTICSAPI_H
+#define SHAREMIND_MOD_TABLEDB_TDBSTATISTICSAPI_H
+
+#ifdef __cplusplus
+#include <cstdint>
+#else
+#include <stdint.h>
+#endif
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Forward declarations: */
+struct SharemindTdbStatistics_;
+typedef struct SharemindTdbStatistics_ SharemindTdbStatistics;
+
+/*******************************************************************************
+    SharemindTdbStatistics
+*******************************************************************************/
+
+/**
+  Syscall call counts, error counts and latency histograms collected by the
+  TableDB module, provided to database modules as the "TdbStatistics" module
+  facility.
+*/
+struct SharemindTdbStatistics_ {
+
+    /** Writes the collected statistics to the TableDB module logger. */
+    void (* dump)(SharemindTdbStatistics * stats);
+
+    /** Resets all collected statistics. */
+    void (* reset)(SharemindTdbStatistics * stats);
+
+    /**
+      \returns the number of calls made to the given TableDB syscall or 0 if
+               no such syscall is instrumented.
+    */
+    uint64_t (* call_count)(SharemindTdbStatistics * stats,
+                            const char * syscall);
+
+};
+
+#ifdef __cplusplus
+} /* extern "C" { */
+#endif
+
+#endif /* SHAREMIND_MOD_TABLEDB_TDBSTATISTICSAPI_H */
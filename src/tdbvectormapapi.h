@@ -85,11 +85,28 @@ enum SharemindTdbVectorMapError_ {
     TDB_VECTOR_MAP_VALUE_NOT_FOUND,
 
     /** Type error. */
-    TDB_VECTOR_MAP_TYPE_ERROR
+    TDB_VECTOR_MAP_TYPE_ERROR,
+
+    /** The memory quota of the vector maps of the process would be exceeded. */
+    TDB_VECTOR_MAP_QUOTA_EXCEEDED
 
 };
 typedef enum SharemindTdbVectorMapError_ SharemindTdbVectorMapError;
 
+/** Releases an external buffer handed over to a vector map. */
+typedef void (* SharemindTdbVectorMapReleaseFn)(void * context);
+
+/**
+  The arrays returned by the get_*_vector functions are owned by the map and
+  remain valid until the vector is next modified. The elements they point to
+  are views into the storage of the vector and must not be freed or modified.
+
+  The set_*_vector functions take ownership of both the given array and its
+  elements on success. The elements are copied into the contiguous storage of
+  the vector and freed immediately, hence the array must have been allocated
+  with new[] and the elements with the SharemindTdb*_new functions declared in
+  TdbTypesUtil.h. On failure the caller retains ownership of both.
+*/
 struct SharemindTdbVectorMap_ {
     SharemindTdbVectorMapError (* get_index_vector)(SharemindTdbVectorMap * map, const char * key, SharemindTdbIndex *** vec, size_t * size);
     SharemindTdbVectorMapError (* set_index_vector)(SharemindTdbVectorMap * map, const char * key, SharemindTdbIndex ** vec, const size_t size);
@@ -117,6 +134,17 @@ struct SharemindTdbVectorMap_ {
     SharemindTdbVectorMapError (* reset)(SharemindTdbVectorMap * map);
 
     uint64_t (* get_id)(SharemindTdbVectorMap * map);
+
+    /**
+      Stores size values of the given type as a new value vector without
+      copying their payloads from buffer. offsets holds size + 1 ascending
+      offsets of the payloads in buffer, or is NULL if every payload is
+      type->size bytes long. The type and the offsets are copied. On success
+      the map calls release(context) once it no longer needs the buffer, which
+      may be as early as the next modification of the vector. Until then the
+      buffer must stay valid and unchanged. On failure release is not called.
+    */
+    SharemindTdbVectorMapError (* set_external_value_vector)(SharemindTdbVectorMap * map, const char * key, const SharemindTdbType * type, const void * buffer, const uint64_t * offsets, const size_t size, SharemindTdbVectorMapReleaseFn release, void * context);
 };
 
 #ifdef __cplusplus
@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+/*
+  Checks that steady-state vector map reads and forwarded reads served by the
+  table cache make no heap allocations, with names longer than the small
+  string buffer. The TableDB module is loaded with the mock database module.
+*/
+
+/* GCC takes the std::free() in the operator delete replacement below, once
+   inlined, for freeing the memory of a mismatched allocation function: */
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <LogHard/Backend.h>
+#include <LogHard/Logger.h>
+#include <LogHard/StdAppender.h>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "../mock/StandInProcess.h"
+#include "../src/ModuleLoader.h"
+
+
+namespace {
+
+std::atomic<std::uint64_t> allocations{0u};
+
+} // anonymous namespace
+
+void * operator new(std::size_t size) {
+    ++allocations;
+    if (void * const p = std::malloc(size ? size : 1u))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void * p) noexcept { std::free(p); }
+void operator delete(void * p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+using namespace sharemind;
+
+char const dsName[] = "allocation_test_data_source";
+char const tblName[] = "allocation_test_table";
+char const vecName[] = "allocation_test_index_vector";
+
+enum Syscall : std::size_t {
+    VmapNew,
+    VmapDelete,
+    VmapPushBackIndex,
+    VmapAtIndex,
+    VmapPushBackString,
+    VmapPushBackType,
+    TblCreate2,
+    TblExists,
+    TblRowCount
+};
+
+std::vector<std::string> const signatures{
+    "tdb_vmap_new",
+    "tdb_vmap_delete",
+    "tdb_vmap_push_back_index",
+    "tdb_vmap_at_index",
+    "tdb_vmap_push_back_string",
+    "tdb_vmap_push_back_type",
+    "tdb_tbl_create2",
+    "tdb_tbl_exists",
+    "tdb_tbl_row_count"
+};
+
+using CRef = SharemindModuleApi0x1CReference;
+
+CRef cref(char const * str) noexcept
+{ return CRef{str, std::char_traits<char>::length(str) + 1u}; }
+
+std::uint64_t call(ModuleLoader::SyscallTable const & syscalls,
+                   mock::StandInProcess & process,
+                   Syscall const syscall,
+                   std::initializer_list<std::uint64_t> args,
+                   std::initializer_list<CRef> crefs)
+{
+    SharemindCodeBlock a[2u];
+    std::size_t n = 0u;
+    for (auto const arg : args)
+        a[n++].uint64[0u] = arg;
+    CRef c[4u];
+    std::size_t m = 0u;
+    for (auto const & r : crefs)
+        c[m++] = r;
+    c[m] = CRef{nullptr, 0u};
+    SharemindCodeBlock returnValue;
+    returnValue.uint64[0u] = 0u;
+
+    auto const & wrapper = syscalls[syscall];
+    auto context(process.context(wrapper.internal));
+    if (wrapper.callable(a, n, nullptr, c, &returnValue, &context)
+            != SHAREMIND_MODULE_API_0x1_OK)
+        throw std::runtime_error("Syscall " + signatures[syscall] + " failed!");
+    return returnValue.uint64[0u];
+}
+
+} // anonymous namespace
+
+int main() {
+    char dir[] = "/tmp/mod_tabledb_tests.XXXXXX";
+    if (!::mkdtemp(dir)) {
+        std::cerr << "Failed to create a temporary directory!" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string const confFile(std::string(dir) + "/tabledb.conf");
+    {
+        std::ofstream f(confFile);
+        f << "[DBModule mock]\n"
+             "File = " SHAREMIND_MOD_TABLEDB_TESTS_MOCK_DB_MODULE "\n"
+             "\n"
+             "[DataSource " << dsName << "]\n"
+             "Name = " << dsName << "\n"
+             "DBModule = tabledb_mock\n"
+             // Not read by the mock database module:
+             "Configuration = " << confFile << "\n"
+             "TableCache = true\n";
+    }
+
+    int r = EXIT_FAILURE;
+    try {
+        auto logBackend(std::make_shared<LogHard::Backend>());
+        logBackend->addAppender(std::make_shared<LogHard::StdAppender>());
+        LogHard::Logger const logger(logBackend);
+        mock::StandInProcess process("ModTableDbAllocationTest");
+
+        ModuleLoader loader(signatures, {}, logger);
+        loader.setModuleFacility("Logger",
+                                 &const_cast<LogHard::Logger &>(logger));
+        if (!loader.addModule(SHAREMIND_MOD_TABLEDB_TESTS_MODULE, confFile))
+            throw std::runtime_error("Failed to load the TableDB module!");
+        auto const & syscalls = *loader.syscallTable("tabledb");
+        auto const run =
+                [&syscalls, &process](Syscall const syscall,
+                                      std::initializer_list<std::uint64_t> a,
+                                      std::initializer_list<CRef> c)
+                { return call(syscalls, process, syscall, a, c); };
+
+        auto const params = run(VmapNew, {}, {});
+        run(VmapPushBackString, {params}, {cref("names"), cref("column")});
+        run(VmapPushBackType,
+            {params, 8u},
+            {cref("types"), cref("public"), cref("uint64")});
+        run(TblCreate2, {params}, {cref(dsName), cref(tblName)});
+        run(VmapDelete, {params}, {});
+
+        auto const vmap = run(VmapNew, {}, {});
+        run(VmapPushBackIndex, {vmap, 42u}, {cref(vecName)});
+
+        r = EXIT_SUCCESS;
+        auto const check =
+                [&r](char const * const name,
+                     std::uint64_t const expected,
+                     auto const & f)
+                {
+                    // The first calls fill the caches:
+                    f();
+                    f();
+
+                    auto const before = allocations.load();
+                    auto const result = f();
+                    auto const allocated = allocations.load() - before;
+                    if (result != expected) {
+                        std::cerr << name << " returned " << result
+                                  << " instead of " << expected << std::endl;
+                        r = EXIT_FAILURE;
+                    }
+                    if (allocated) {
+                        std::cerr << name << " made " << allocated
+                                  << " heap allocations" << std::endl;
+                        r = EXIT_FAILURE;
+                    }
+                };
+        check("tdb_vmap_at_index", 42u, [&run, vmap] {
+            return run(VmapAtIndex, {vmap, 0u}, {cref(vecName)});
+        });
+        check("tdb_tbl_exists", 1u, [&run] {
+            return run(TblExists, {}, {cref(dsName), cref(tblName)});
+        });
+        check("tdb_tbl_row_count", 0u, [&run] {
+            return run(TblRowCount, {}, {cref(dsName), cref(tblName)});
+        });
+
+        run(VmapDelete, {vmap}, {});
+        process.end();
+    } catch (std::exception const & e) {
+        std::cerr << "Test failed: " << e.what() << std::endl;
+        r = EXIT_FAILURE;
+    }
+    std::remove(confFile.c_str());
+    ::rmdir(dir);
+    return r;
+}